@@ -0,0 +1,518 @@
+// Microbenchmarks for the settings parsers, PE export/import lookups & the hook decision logic
+// Results are written as JSON so runs can be compared between builds
+//
+// usage: dlsstweaks_bench [output.json] [--min-time-ms N] [--ini path]
+// (writes JSON to stdout if no output path is given)
+//
+// When the ini-cpp submodule is checked out the INI parser is also compared against inih (DLSSTWEAKS_BENCH_INIH)
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "HookLogic.hpp"
+#include "IniParser.hpp"
+#include "PeBuilder.hpp"
+#include "PeImage.hpp"
+#include "UtilityParse.hpp"
+
+#ifdef DLSSTWEAKS_BENCH_INIH
+#include <ini.h>
+#endif
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+// Each benchmark is timed this many times, best & median of them are reported
+constexpr int NumSamples = 7;
+
+#ifdef DLSSTWEAKS_BENCH_CONFIG
+constexpr const char* BuildConfig = DLSSTWEAKS_BENCH_CONFIG;
+#else
+constexpr const char* BuildConfig = "";
+#endif
+
+// NDEBUG only says whether asserts are on, GCC/Clang define __OPTIMIZE__ for any -O level instead
+// MSVC has nothing equivalent, but every CMake config besides Debug (and an unset one) builds with /O1 or /O2
+constexpr bool BuildOptimized()
+{
+#if defined(__OPTIMIZE__)
+	return true;
+#elif defined(_MSC_VER)
+	return std::string_view(BuildConfig) != "" && std::string_view(BuildConfig) != "Debug";
+#else
+	return false;
+#endif
+}
+
+// Fallback for when the INI shipped with DLSSTweaks can't be found
+constexpr std::string_view FallbackIni = R"([DLSS]
+ForceDLAA = false
+OverrideAutoExposure = 0
+OverrideAlphaUpscaling = 0
+OverrideHDR = 0
+OverrideDlssHud = -1
+DisableDevWatermark = true
+
+[DLSSQualityLevels]
+Enable = true
+UltraQuality = 0.769231
+Quality = 0.66666667
+Balanced = 0.58
+Performance = 0.5
+UltraPerformance = 0.33333334
+
+[DLSSPresets]
+DLAA = Default
+UltraPerformance = Default
+Performance = Default
+Balanced = Default
+Quality = Default
+UltraQuality = Default
+
+[Compatibility]
+ResolutionOffset = 0
+DynamicResolutionOverride = true
+DynamicResolutionMinOffset = -1
+DisableIniMonitoring = false
+)";
+
+// Size of the generated INI used to compare parsers, a few hundred KB
+constexpr int GeneratedSections = 256;
+constexpr int GeneratedKeysPerSection = 32;
+
+// Export counts of the generated PE images, the large one is past what pe::Image hashes so lookups binary search instead
+constexpr int GeneratedExports = 200;
+constexpr int GeneratedExportsLarge = 8192;
+
+// Stops the compiler from optimizing away results that are never used
+template <typename T>
+void keep(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : "r,m"(value) : "memory");
+#else
+	static volatile const void* sink;
+	sink = &value;
+#endif
+}
+
+// Inputs are cycled through so the calls can't be constant-folded, sizes are kept to powers of 2 so picking one is just a mask
+template <typename T, size_t N>
+const T& pick(const std::array<T, N>& inputs, uint64_t i)
+{
+	static_assert((N & (N - 1)) == 0, "input count must be a power of 2");
+	return inputs[i & (N - 1)];
+}
+
+struct Result
+{
+	std::string name;
+	uint64_t iterations = 0; // per sample
+	double bestNs = 0.0;
+	double medianNs = 0.0;
+};
+
+class Runner
+{
+public:
+	explicit Runner(std::chrono::milliseconds minTime) : m_minTime(minTime) {}
+
+	template <typename Fn>
+	void run(const char* name, Fn&& fn)
+	{
+		// Find an iteration count that takes long enough to time reliably
+		uint64_t iterations = 1;
+		const auto target = std::chrono::duration_cast<Clock::duration>(m_minTime) / NumSamples;
+		for (;;)
+		{
+			const auto elapsed = time(fn, iterations);
+			if (elapsed >= target || iterations >= (1ull << 40))
+				break;
+			iterations *= elapsed.count() > 0 ? std::clamp<uint64_t>(uint64_t(target / elapsed) + 1, 2, 10) : 10;
+		}
+
+		std::array<double, NumSamples> samples;
+		for (auto& sample : samples)
+			sample = std::chrono::duration<double, std::nano>(time(fn, iterations)).count() / double(iterations);
+		std::sort(samples.begin(), samples.end());
+
+		Result result{ name, iterations, samples.front(), samples[NumSamples / 2] };
+		fprintf(stderr, "%-40s %12.2f ns/op (median %.2f, %llu iterations)\n", name, result.bestNs, result.medianNs,
+			(unsigned long long)iterations);
+		m_results.push_back(std::move(result));
+	}
+
+	const std::vector<Result>& results() const { return m_results; }
+
+private:
+	template <typename Fn>
+	static Clock::duration time(Fn& fn, uint64_t iterations)
+	{
+		const auto start = Clock::now();
+		for (uint64_t i = 0; i < iterations; i++)
+			fn(i);
+		return Clock::now() - start;
+	}
+
+	std::chrono::milliseconds m_minTime;
+	std::vector<Result> m_results;
+};
+
+std::string read_ini(const char* path, bool& fromFile)
+{
+	fromFile = false;
+	if (path)
+	{
+		ini::MappedFile file(path);
+		if (file.is_open())
+		{
+			fromFile = true;
+			return std::string(file.view());
+		}
+	}
+	return std::string(FallbackIni);
+}
+
+// Large multi-section INI in the subset of syntax that both our parser & inih read the same way
+// (comments, blank lines, : delimiters, inline ; comments, quoted & padded values)
+std::string generate_ini(int numSections, int keysPerSection)
+{
+	std::string text;
+	text.reserve(size_t(numSections) * size_t(keysPerSection) * 40);
+
+	char line[128];
+	for (int section = 0; section < numSections; section++)
+	{
+		snprintf(line, sizeof(line), "; settings group %d\n[Section%d]\n", section, section);
+		text += line;
+		for (int key = 0; key < keysPerSection; key++)
+		{
+			switch (key % 8)
+			{
+			case 0: snprintf(line, sizeof(line), "Key%d = %d\n", key, section * keysPerSection + key); break;
+			case 1: snprintf(line, sizeof(line), "Key%d=0.%d\n", key, key * 7919 % 10000); break;
+			case 2: snprintf(line, sizeof(line), "Key%d : %dx%d\n", key, 1280 + key, 720 + section); break;
+			case 3: snprintf(line, sizeof(line), "Key%d = true ; inline comment\n", key); break;
+			case 4: snprintf(line, sizeof(line), "\n# comment before Key%d\n", key); break;
+			case 5: snprintf(line, sizeof(line), "  Key%d   =   \"C:\\Games\\Game%d\\nvngx_dlss.dll\"  \n", key, section); break;
+			case 6: snprintf(line, sizeof(line), "Key%d = Default\n", key); break;
+			default: snprintf(line, sizeof(line), "Key%d = some longer value for section %d key %d\n", key, section, key); break;
+			}
+			text += line;
+		}
+		text += "\n";
+	}
+	return text;
+}
+
+// PE image with numExports named exports (winmm.dll has around 200) & a few import modules
+std::vector<uint8_t> generate_pe(int numExports)
+{
+	tests::PeBuilder builder;
+	for (int i = 0; i < numExports; i++)
+		builder.add_export("Export" + std::to_string(i), uint32_t(0x10000 + i * 16));
+	builder.add_import("KERNEL32.dll", { "GetProcAddress", "LoadLibraryExW", "GetModuleHandleW", "VirtualProtect", "Sleep" });
+	builder.add_import("USER32.dll", { "MessageBoxW" });
+	builder.add_import("ADVAPI32.dll", { "RegOpenKeyExW", "RegQueryValueExW", "RegCloseKey" });
+	return builder.build();
+}
+
+#ifdef DLSSTWEAKS_BENCH_INIH
+// inih only reads from a FILE*, so the generated INI is handed to it through an in-memory stream (or a temp file on Windows)
+// The stream is rewound before each parse, so only inih's own work ends up being timed
+FILE* open_text_stream(const std::string& text)
+{
+#ifdef _WIN32
+	FILE* file = tmpfile();
+	if (file)
+		fwrite(text.data(), 1, text.size(), file);
+	return file;
+#else
+	return fmemopen((void*)text.data(), text.size(), "r");
+#endif
+}
+#endif
+
+void write_json(FILE* out, const std::vector<Result>& results, std::chrono::milliseconds minTime, bool iniFromFile, size_t generatedIniSize)
+{
+	fprintf(out, "{\n");
+	fprintf(out, "  \"context\": {\n");
+#if defined(__clang__)
+	fprintf(out, "    \"compiler\": \"clang %d.%d.%d\",\n", __clang_major__, __clang_minor__, __clang_patchlevel__);
+#elif defined(__GNUC__)
+	fprintf(out, "    \"compiler\": \"gcc %d.%d.%d\",\n", __GNUC__, __GNUC_MINOR__, __GNUC_PATCHLEVEL__);
+#elif defined(_MSC_VER)
+	fprintf(out, "    \"compiler\": \"msvc %d\",\n", _MSC_FULL_VER);
+#else
+	fprintf(out, "    \"compiler\": \"unknown\",\n");
+#endif
+	fprintf(out, "    \"config\": \"%s\",\n", BuildConfig);
+	fprintf(out, "    \"optimized\": %s,\n", BuildOptimized() ? "true" : "false");
+	fprintf(out, "    \"min_time_ms\": %lld,\n", (long long)minTime.count());
+	fprintf(out, "    \"samples\": %d,\n", NumSamples);
+	fprintf(out, "    \"ini_source\": \"%s\",\n", iniFromFile ? "file" : "builtin");
+	fprintf(out, "    \"generated_ini_bytes\": %llu,\n", (unsigned long long)generatedIniSize);
+#ifdef DLSSTWEAKS_BENCH_INIH
+	fprintf(out, "    \"inih\": true\n");
+#else
+	fprintf(out, "    \"inih\": false\n");
+#endif
+	fprintf(out, "  },\n");
+	fprintf(out, "  \"benchmarks\": [\n");
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const auto& result = results[i];
+		fprintf(out, "    { \"name\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.3f, \"ns_per_op_median\": %.3f }%s\n",
+			result.name.c_str(), (unsigned long long)result.iterations, result.bestNs, result.medianNs, i + 1 < results.size() ? "," : "");
+	}
+	fprintf(out, "  ]\n");
+	fprintf(out, "}\n");
+}
+};
+
+int main(int argc, char** argv)
+{
+	const char* outputPath = nullptr;
+	long long minTimeMs = 500;
+#ifdef DLSSTWEAKS_BENCH_INI
+	const char* iniPath = DLSSTWEAKS_BENCH_INI;
+#else
+	const char* iniPath = nullptr;
+#endif
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "--min-time-ms") && i + 1 < argc)
+			minTimeMs = std::max(1ll, atoll(argv[++i]));
+		else if (!strcmp(argv[i], "--ini") && i + 1 < argc)
+			iniPath = argv[++i];
+		else
+			outputPath = argv[i];
+	}
+
+	const auto minTime = std::chrono::milliseconds(minTimeMs);
+	Runner runner(minTime);
+
+	// Settings parsers
+
+	const std::array<std::string_view, 8> resolutions = {
+		"1920x1080", "2560x1440", " 3840 x 2160 ", "1280x720", "0x0", "1920", "abcxdef", "3440x1440",
+	};
+	runner.run("utility::ParseResolution", [&](uint64_t i) {
+		keep(utility::ParseResolution(pick(resolutions, i)));
+	});
+
+	const std::array<std::string_view, 8> floats = {
+		"0.5", "0,58", "0.66666667", "1", "0.33333334", "0.769231", "-1", "0.0",
+	};
+	runner.run("utility::stof_nolocale", [&](uint64_t i) {
+		keep(utility::stof_nolocale(pick(floats, i), true));
+	});
+
+	const std::array<std::string_view, 8> presets = {
+		"A", "b", "C", "Default", "f", "G", "", "K",
+	};
+	runner.run("utility::DLSS_PresetNameToEnum", [&](uint64_t i) {
+		keep(utility::DLSS_PresetNameToEnum(pick(presets, i)));
+	});
+
+	const std::array<std::string_view, 4> quoted = {
+		"\"C:\\Games\\nvngx_dlss.dll\"", "  'quoted'  ", "plain", " \" spaced \" ",
+	};
+	runner.run("ini::trim_quotes", [&](uint64_t i) {
+		keep(ini::trim_quotes(pick(quoted, i)));
+	});
+
+	// ini_get_string_safe was replaced by the streaming INI parser, lookups go through ini::find_value now
+	bool iniFromFile = false;
+	const std::string iniText = read_ini(iniPath, iniFromFile);
+	const std::array<std::pair<std::string_view, std::string_view>, 4> iniKeys = { {
+		{ "DLSS", "ForceDLAA" },
+		{ "DLSSQualityLevels", "Balanced" },
+		{ "Compatibility", "DisableIniMonitoring" },
+		{ "DLSS", "MissingKey" },
+	} };
+	runner.run("ini::find_value", [&](uint64_t i) {
+		const auto& [section, key] = pick(iniKeys, i);
+		keep(ini::find_value(iniText, section, key));
+	});
+
+	runner.run("ini::parse", [&](uint64_t) {
+		size_t count = 0;
+		ini::parse(iniText, [&](const ini::Entry&) {
+			count++;
+			return true;
+		});
+		keep(count);
+	});
+
+	// Parser comparison on a large generated INI
+	const std::string largeIni = generate_ini(GeneratedSections, GeneratedKeysPerSection);
+	const std::array<std::pair<std::string, std::string>, 4> largeIniKeys = { {
+		{ "Section0", "Key0" },
+		{ "Section128", "Key21" },
+		{ "Section255", "Key31" },
+		{ "Section255", "MissingKey" },
+	} };
+
+	runner.run("ini::parse (generated)", [&](uint64_t) {
+		size_t count = 0;
+		ini::parse(largeIni, [&](const ini::Entry&) {
+			count++;
+			return true;
+		});
+		keep(count);
+	});
+
+	runner.run("ini::find_value (generated)", [&](uint64_t i) {
+		const auto& [section, key] = pick(largeIniKeys, i);
+		keep(ini::find_value(largeIni, section, key));
+	});
+
+#ifdef DLSSTWEAKS_BENCH_INIH
+	if (FILE* stream = open_text_stream(largeIni))
+	{
+		runner.run("inih::INIReader (generated)", [&](uint64_t) {
+			rewind(stream);
+			inih::INIReader reader(stream);
+			keep(reader.Sections().size());
+		});
+
+		// Lookups are against an already-parsed reader, unlike ini::find_value which scans the text each time
+		rewind(stream);
+		const inih::INIReader reader(stream);
+		runner.run("inih::INIReader::Get (generated)", [&](uint64_t i) {
+			const auto& [section, key] = pick(largeIniKeys, i);
+			keep(reader.Get<std::string>(section, key, std::string()));
+		});
+
+		fclose(stream);
+	}
+	else
+		fprintf(stderr, "failed to create a stream for inih, skipping its benchmarks\n");
+#endif
+
+	// PE export/import lookups, as done by the proxy & the IAT hooks
+
+	const auto peFile = generate_pe(GeneratedExports);
+	runner.run("pe::Image::parse_file", [&](uint64_t) {
+		pe::Image image;
+		keep(image.parse_file(peFile.data(), peFile.size()));
+	});
+
+	pe::Image peImage;
+	peImage.parse_file(peFile.data(), peFile.size());
+	const std::array<std::string_view, 4> exportNames = { "Export0", "Export117", "Export199", "MissingExport" };
+	runner.run("pe::Image::find_export", [&](uint64_t i) {
+		keep(peImage.find_export(pick(exportNames, i)).rva);
+	});
+
+	const auto largePeFile = generate_pe(GeneratedExportsLarge);
+	pe::Image largePeImage;
+	largePeImage.parse_file(largePeFile.data(), largePeFile.size());
+	const std::array<std::string_view, 4> largeExportNames = { "Export0", "Export4321", "Export8191", "MissingExport" };
+	runner.run("pe::Image::find_export (binary search)", [&](uint64_t i) {
+		keep(largePeImage.find_export(pick(largeExportNames, i)).rva);
+	});
+
+	const std::array<std::pair<std::string_view, std::string_view>, 4> imports = { {
+		{ "KERNEL32.dll", "GetProcAddress" },
+		{ "kernel32.dll", "Sleep" },
+		{ "ADVAPI32.dll", "RegCloseKey" },
+		{ "GDI32.dll", "BitBlt" },
+	} };
+	runner.run("pe::Image::find_import", [&](uint64_t i) {
+		const auto& [module, function] = pick(imports, i);
+		keep(peImage.find_import(module, function));
+	});
+
+	// Hook decision logic
+
+	const std::array<hook_logic::FeatureFlagOverrides, 4> flagOverrides = { {
+		{},
+		{ 1, -1, 0, false, true },
+		{ -1, 1, 1, true, false },
+		{ 0, 0, -1, false, false },
+	} };
+	runner.run("hook_logic::override_feature_flags", [&](uint64_t i) {
+		keep(hook_logic::override_feature_flags(int(i & 0x7F), pick(flagOverrides, i)));
+	});
+
+	QualityLevel ultraQuality{ "UltraQuality" };
+	ultraQuality.scalingRatio = 0.769231f;
+	runner.run("hook_logic::dlss_quality_value", [&](uint64_t i) {
+		keep(hook_logic::dlss_quality_value(int(i & 7), ultraQuality));
+	});
+
+	const std::array<std::string_view, 8> parameterNames = {
+		NVSDK_NGX_Parameter_OutWidth,
+		NVSDK_NGX_Parameter_OutHeight,
+		NVSDK_NGX_Parameter_Width,
+		NVSDK_NGX_Parameter_DLSS_Get_Dynamic_Min_Render_Width,
+		NVSDK_NGX_Parameter_DLSS_Get_Dynamic_Max_Render_Height,
+		NVSDK_NGX_Parameter_Sharpness,
+		NVSDK_NGX_Parameter_SuperSampling_Available,
+		NVSDK_NGX_Parameter_PerfQualityValue,
+	};
+	runner.run("hook_logic::classify_resolution_query", [&](uint64_t i) {
+		keep(hook_logic::classify_resolution_query(pick(parameterNames, i), true));
+	});
+
+	// Ratios from the default INI, with a custom resolution on one of them
+	QualityTable qualities;
+	qualities[NVSDK_NGX_PerfQuality_Value_UltraPerformance].scalingRatio = 0.33333334f;
+	qualities[NVSDK_NGX_PerfQuality_Value_MaxPerf].scalingRatio = 0.5f;
+	qualities[NVSDK_NGX_PerfQuality_Value_Balanced].scalingRatio = 0.58f;
+	qualities[NVSDK_NGX_PerfQuality_Value_MaxQuality].scalingRatio = 0.66666667f;
+	qualities[NVSDK_NGX_PerfQuality_Value_UltraQuality].resolution = { 3000, 1687 };
+	qualities[NVSDK_NGX_PerfQuality_Value_DLAA].scalingRatio = 1.0f;
+
+	const std::array<std::pair<unsigned int, unsigned int>, 4> targets = { {
+		{ 1920, 1080 }, { 2560, 1440 }, { 3840, 2160 }, { 3440, 1440 },
+	} };
+	runner.run("hook_logic::render_resolution", [&](uint64_t i) {
+		const auto& [width, height] = pick(targets, i);
+		keep(hook_logic::render_resolution(qualities[NVSDK_NGX_PerfQuality_Value(i % NumQualityLevels)], width, height, 0));
+	});
+
+	// Preset selection works from the resolutions we last reported to the game, set those up for a 4K display
+	ReportedResolutions reported{};
+	std::array<std::pair<int, int>, 8> renderResolutions{};
+	for (auto& [level, quality] : qualities)
+	{
+		const auto res = hook_logic::render_resolution(quality, 3840, 2160, 0);
+		reported[size_t(level)] = { int(res.first), int(res.second) };
+		quality.preset = NVSDK_NGX_DLSS_Hint_Render_Preset_A + unsigned(level % 5);
+		renderResolutions[size_t(level)] = reported[size_t(level)];
+	}
+	renderResolutions[6] = { 1234, 567 }; // no match
+	renderResolutions[7] = { 3839, 2161 }; // DLAA, within a pixel
+	runner.run("hook_logic::select_preset", [&](uint64_t i) {
+		keep(hook_logic::select_preset(qualities, reported, pick(renderResolutions, i), { 3840, 2160 }).preset);
+	});
+
+	if (outputPath)
+	{
+		FILE* out = fopen(outputPath, "w");
+		if (!out)
+		{
+			fprintf(stderr, "failed to open %s for writing\n", outputPath);
+			return 1;
+		}
+		write_json(out, runner.results(), minTime, iniFromFile, largeIni.size());
+		fclose(out);
+	}
+	else
+		write_json(stdout, runner.results(), minTime, iniFromFile, largeIni.size());
+
+	return 0;
+}
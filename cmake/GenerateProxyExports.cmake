@@ -0,0 +1,107 @@
+# Generates the proxy export wrappers from src/ProxyExports.txt
+# > cmake -DMANIFEST=src/ProxyExports.txt -DOUTPUT_DIR=build/generated -P cmake/GenerateProxyExports.cmake
+#
+# Outputs:
+#   Proxy.def         - ordinals for every export that has one in the manifest
+#   ProxyWinmm.inc    - winmm.dll slots, passthrough stubs & name-sorted lookup table, included by Proxy.cpp
+#   ProxyNvngx.inc    - nvngx.dll slots, passthrough stubs & name-sorted lookup table, included by ProxyNvngx.cpp
+
+cmake_minimum_required(VERSION 3.15)
+
+if(NOT MANIFEST OR NOT OUTPUT_DIR)
+	message(FATAL_ERROR "GenerateProxyExports: MANIFEST and OUTPUT_DIR must be set")
+endif()
+
+file(STRINGS "${MANIFEST}" manifest_lines)
+
+set(def_entries "")
+set(winmm_names "")
+set(nvngx_names "")
+set(nvngx_stub_names "")
+set(seen_names "")
+set(seen_ordinals "")
+
+foreach(line IN LISTS manifest_lines)
+	string(STRIP "${line}" line)
+	if(line STREQUAL "" OR line MATCHES "^#")
+		continue()
+	endif()
+
+	if(NOT line MATCHES "^([a-z]+)[ \t]+([A-Za-z0-9_]+)([ \t]+@([0-9]+))?$")
+		message(FATAL_ERROR "GenerateProxyExports: malformed line \"${line}\"")
+	endif()
+	set(kind "${CMAKE_MATCH_1}")
+	set(name "${CMAKE_MATCH_2}")
+	set(ordinal "${CMAKE_MATCH_4}")
+
+	if(name IN_LIST seen_names)
+		message(FATAL_ERROR "GenerateProxyExports: ${name} is listed more than once")
+	endif()
+	list(APPEND seen_names "${name}")
+
+	if(NOT ordinal STREQUAL "")
+		if(ordinal IN_LIST seen_ordinals)
+			message(FATAL_ERROR "GenerateProxyExports: ordinal @${ordinal} (${name}) is used more than once")
+		endif()
+		list(APPEND seen_ordinals "${ordinal}")
+		string(APPEND def_entries "  ${name} @${ordinal}\n")
+	endif()
+
+	if(kind STREQUAL "winmm")
+		list(APPEND winmm_names "${name}")
+	elseif(kind STREQUAL "nvngx")
+		list(APPEND nvngx_names "${name}")
+		list(APPEND nvngx_stub_names "${name}")
+	elseif(kind STREQUAL "hooked")
+		list(APPEND nvngx_names "${name}")
+	elseif(NOT kind STREQUAL "stub" AND NOT kind STREQUAL "typed")
+		message(FATAL_ERROR "GenerateProxyExports: unknown kind \"${kind}\" for ${name}")
+	endif()
+endforeach()
+
+# Export name tables in a PE are sorted by plain byte comparison, same as strcmp & list(SORT), so the generated tables can be merge-joined against them
+list(SORT winmm_names COMPARE STRING CASE SENSITIVE)
+list(SORT nvngx_names COMPARE STRING CASE SENSITIVE)
+
+set(header "// Generated from ProxyExports.txt by cmake/GenerateProxyExports.cmake - DO NOT EDIT\n")
+
+# slots, stubs & table for one module
+function(generate_module out_var names stub_names suffix table_name)
+	set(content "${header}\n")
+
+	foreach(name IN LISTS names)
+		string(APPEND content "FARPROC ${name}${suffix} = nullptr;\n")
+	endforeach()
+
+	foreach(name IN LISTS stub_names)
+		string(APPEND content "\nPLUGIN_API void ${name}()\n{\n    ${name}${suffix}();\n}\n")
+	endforeach()
+
+	list(LENGTH names count)
+	string(APPEND content "\n// Sorted by name, for proxy::resolve_exports\nconst proxy::ExportSlot ${table_name}[${count}] = {\n")
+	foreach(name IN LISTS names)
+		string(APPEND content "    { \"${name}\", &${name}${suffix} },\n")
+	endforeach()
+	string(APPEND content "};\n")
+
+	set(${out_var} "${content}" PARENT_SCOPE)
+endfunction()
+
+generate_module(winmm_inc "${winmm_names}" "${winmm_names}" "_orig" "WinmmExports")
+generate_module(nvngx_inc "${nvngx_names}" "${nvngx_stub_names}" "_Orig" "NvngxExports")
+
+# Only touch outputs that actually changed, so rebuilding after a manifest edit doesn't recompile more than needed
+function(write_if_changed path content)
+	if(EXISTS "${path}")
+		file(READ "${path}" existing)
+		if(existing STREQUAL content)
+			return()
+		endif()
+	endif()
+	file(WRITE "${path}" "${content}")
+endfunction()
+
+file(MAKE_DIRECTORY "${OUTPUT_DIR}")
+write_if_changed("${OUTPUT_DIR}/Proxy.def" "; Generated from ProxyExports.txt by cmake/GenerateProxyExports.cmake - DO NOT EDIT\nEXPORTS\n${def_entries}")
+write_if_changed("${OUTPUT_DIR}/ProxyWinmm.inc" "${winmm_inc}")
+write_if_changed("${OUTPUT_DIR}/ProxyNvngx.inc" "${nvngx_inc}")
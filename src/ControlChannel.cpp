@@ -0,0 +1,275 @@
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+
+#include <memory>
+#include <string>
+
+#include "ControlCommands.hpp"
+#include "DLSSTweaks.hpp"
+#include "Log.hpp"
+#include "IniParser.hpp"
+#include "SettingsSchema.hpp"
+
+namespace control
+{
+namespace
+{
+constexpr DWORD PipeBufferSize = 4096;
+
+const SettingDef* FindSettingByName(std::string_view name)
+{
+	const size_t separator = name.find('.');
+	if (separator == std::string_view::npos)
+		return nullptr;
+	return FindSetting(name.substr(0, separator), name.substr(separator + 1));
+}
+
+// Reads come from the published snapshot, sets & reloads go through the working copy like INI reads do
+class SettingsTarget final : public CommandTarget
+{
+public:
+	bool get(std::string_view name, std::string& value) const override
+	{
+		const SettingDef* def = FindSettingByName(name);
+		if (!def)
+			return false;
+
+		value = current_settings()->format_value(*def);
+		return true;
+	}
+
+	std::vector<std::pair<std::string, std::string>> list() const override
+	{
+		// Listed from a single snapshot, so a reload happening at the same time can't mix old & new values
+		const auto current = current_settings();
+		std::vector<std::pair<std::string, std::string>> values;
+		values.reserve(SettingsSchema.size());
+		for (const auto& def : SettingsSchema)
+			values.emplace_back(fmt::format("{}.{}", def.section, def.key), current->format_value(def));
+		return values;
+	}
+
+	Check check(std::string_view name, std::string_view value) const override
+	{
+		const SettingDef* def = FindSettingByName(name);
+		if (!def)
+			return Check::UnknownSetting;
+		return UserSettings::valid_value(*def, value) ? Check::Valid : Check::InvalidValue;
+	}
+
+	void set(const std::vector<std::pair<std::string_view, std::string_view>>& values) override
+	{
+		std::vector<std::pair<const SettingDef*, std::string_view>> defs;
+		defs.reserve(values.size());
+		for (const auto& [name, value] : values)
+			defs.emplace_back(FindSettingByName(name), value);
+
+		settings.set_values(defs);
+	}
+
+	bool reload() override
+	{
+		return settings.reload();
+	}
+
+	std::string stats() const override
+	{
+		return fmt::format("wakeups={} ignored={} relevant={} overflows={} reloads={} redundant={}",
+			iniWatchStats.wakeups.load(), iniWatchStats.ignoredEvents.load(), iniWatchStats.relevantEvents.load(),
+			iniWatchStats.overflows.load(), iniWatchStats.reloads.load(), iniWatchStats.redundantReloads.load());
+	}
+};
+
+// Single-instance message pipe, driven from the service thread
+// Only one client can be connected at a time, which is plenty for tooling
+class PipeServer
+{
+public:
+	~PipeServer()
+	{
+		if (m_pipe != INVALID_HANDLE_VALUE)
+		{
+			// A pending connect/read still points at m_overlapped & m_buffer, so the kernel has to be done with it before they're freed
+			if (m_overlapped.hEvent && CancelIoEx(m_pipe, &m_overlapped))
+			{
+				DWORD bytesTransferred = 0;
+				GetOverlappedResult(m_pipe, &m_overlapped, &bytesTransferred, TRUE);
+			}
+			DisconnectNamedPipe(m_pipe);
+			CloseHandle(m_pipe);
+		}
+		if (m_writeEvent)
+			CloseHandle(m_writeEvent);
+		if (m_overlapped.hEvent)
+		{
+			service::remove_handle(m_overlapped.hEvent);
+			CloseHandle(m_overlapped.hEvent);
+		}
+	}
+
+	bool start()
+	{
+		const std::wstring pipeName = L"\\\\.\\pipe\\DLSSTweaks_" + std::to_wstring(GetCurrentProcessId());
+
+		// Default security only gives the current user & admins write access, remote clients are rejected outright
+		m_pipe = CreateNamedPipeW(pipeName.c_str(),
+			PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED | FILE_FLAG_FIRST_PIPE_INSTANCE,
+			PIPE_TYPE_MESSAGE | PIPE_READMODE_MESSAGE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+			1, PipeBufferSize, PipeBufferSize, 0, NULL);
+
+		if (m_pipe == INVALID_HANDLE_VALUE)
+		{
+			spdlog::error("Control pipe: CreateNamedPipeW failed with error code {}", GetLastError());
+			return false;
+		}
+
+		// Manual-reset, as ConnectNamedPipe/ReadFile expect for overlapped IO
+		m_overlapped.hEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+		m_writeEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+		if (!m_overlapped.hEvent || !m_writeEvent)
+		{
+			spdlog::error("Control pipe: CreateEvent failed with error code {}", GetLastError());
+			return false;
+		}
+
+		if (!service::add_handle(m_overlapped.hEvent, [this]() { on_complete(); }))
+		{
+			spdlog::error("Control pipe: too many handles registered with service thread");
+			CloseHandle(std::exchange(m_overlapped.hEvent, nullptr));
+			return false;
+		}
+
+		if (!connect())
+			return false;
+
+		spdlog::info("Control pipe: listening on {}", std::filesystem::path(pipeName).string());
+		return true;
+	}
+
+private:
+	enum class State
+	{
+		Connecting,
+		Reading,
+	};
+
+	bool connect()
+	{
+		m_state = State::Connecting;
+		if (ConnectNamedPipe(m_pipe, &m_overlapped))
+			return true;
+
+		switch (GetLastError())
+		{
+		case ERROR_IO_PENDING:
+			return true;
+		case ERROR_PIPE_CONNECTED:
+			// Client connected before we started waiting, event won't be signaled for it so do that ourselves
+			SetEvent(m_overlapped.hEvent);
+			return true;
+		default:
+			spdlog::error("Control pipe: ConnectNamedPipe failed with error code {}", GetLastError());
+			return false;
+		}
+	}
+
+	void reconnect()
+	{
+		DisconnectNamedPipe(m_pipe);
+		connect();
+	}
+
+	void begin_read()
+	{
+		m_state = State::Reading;
+
+		// Overlapped reads signal the event even if they complete straight away, so on_complete handles both cases
+		if (!ReadFile(m_pipe, m_buffer, sizeof(m_buffer), NULL, &m_overlapped) && GetLastError() != ERROR_IO_PENDING)
+			reconnect();
+	}
+
+	void on_complete()
+	{
+		DWORD bytesRead = 0;
+		const BOOL success = GetOverlappedResult(m_pipe, &m_overlapped, &bytesRead, FALSE);
+		const DWORD error = success ? ERROR_SUCCESS : GetLastError();
+
+		if (m_state == State::Connecting)
+		{
+			if (!success && error != ERROR_PIPE_CONNECTED)
+			{
+				reconnect();
+				return;
+			}
+
+			spdlog::debug("Control pipe: client connected");
+			begin_read();
+			return;
+		}
+
+		if (!success)
+		{
+			// Anything other than a too-long message means the client has gone away
+			if (error == ERROR_MORE_DATA)
+				spdlog::warn("Control pipe: command longer than {} bytes, disconnecting client", PipeBufferSize);
+			else
+				spdlog::debug("Control pipe: client disconnected");
+
+			reconnect();
+			return;
+		}
+
+		const std::string_view command(m_buffer, bytesRead);
+		const std::string reply = execute(command, m_target);
+		spdlog::debug("Control pipe: \"{}\" -> \"{}\"", ini::trim(command), reply.substr(0, reply.find('\n')));
+
+		// Replies are small, waiting for the write here keeps the state machine simple
+		OVERLAPPED writeOverlapped{};
+		writeOverlapped.hEvent = m_writeEvent;
+		DWORD bytesWritten = 0;
+		if (!WriteFile(m_pipe, reply.data(), DWORD(reply.size()), NULL, &writeOverlapped) && GetLastError() != ERROR_IO_PENDING)
+		{
+			reconnect();
+			return;
+		}
+		if (!GetOverlappedResult(m_pipe, &writeOverlapped, &bytesWritten, TRUE))
+		{
+			reconnect();
+			return;
+		}
+
+		begin_read();
+	}
+
+	HANDLE m_pipe = INVALID_HANDLE_VALUE;
+	HANDLE m_writeEvent = nullptr;
+	OVERLAPPED m_overlapped{};
+	State m_state = State::Connecting;
+	char m_buffer[PipeBufferSize];
+	SettingsTarget m_target;
+};
+
+std::unique_ptr<PipeServer> pipeServer; // only touched from the service thread
+};
+
+void settings_changed()
+{
+	// Pipe lives on the service thread, hand the start/stop over to it
+	const bool enable = current_settings()->enableControlPipe;
+	service::post([enable]() {
+		if (enable == bool(pipeServer))
+			return;
+
+		if (!enable)
+		{
+			pipeServer.reset();
+			spdlog::info("Control pipe: stopped");
+			return;
+		}
+
+		pipeServer = std::make_unique<PipeServer>();
+		if (!pipeServer->start())
+			pipeServer.reset();
+	});
+}
+};
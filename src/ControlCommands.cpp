@@ -0,0 +1,95 @@
+#include "ControlCommands.hpp"
+#include "IniParser.hpp"
+#include "Log.hpp"
+
+// Commands are plain text, one per pipe message, with the reply sent back as a single message:
+//   get Section.Key                    -> "ok <value>"
+//   set Section.Key=value [...]        -> "ok", all values are applied together (or none of them if any are invalid)
+//   list                               -> "ok" followed by a Section.Key=value line for every setting
+//   reload                             -> re-reads the INIs, dropping anything changed via set
+//   stats                              -> INI watcher counters
+// Errors are returned as "err <reason>"
+namespace control
+{
+namespace
+{
+std::string_view NextToken(std::string_view& str)
+{
+	str = ini::trim(str);
+	size_t end = 0;
+	while (end < str.size() && !ini::is_space(str[end]))
+		end++;
+
+	const auto token = str.substr(0, end);
+	str.remove_prefix(end);
+	return token;
+}
+};
+
+std::string execute(std::string_view command, CommandTarget& target)
+{
+	const auto verb = NextToken(command);
+
+	if (ini::iequals(verb, "get"))
+	{
+		const auto name = NextToken(command);
+		std::string value;
+		if (!target.get(name, value))
+			return fmt::format("err unknown setting {}", name);
+
+		return "ok " + value;
+	}
+
+	if (ini::iequals(verb, "set"))
+	{
+		std::vector<std::pair<std::string_view, std::string_view>> values;
+		for (auto token = NextToken(command); !token.empty(); token = NextToken(command))
+		{
+			const size_t separator = token.find('=');
+			if (separator == std::string_view::npos)
+				return fmt::format("err expected Section.Key=value, got {}", token);
+
+			const auto name = token.substr(0, separator);
+			const auto value = token.substr(separator + 1);
+
+			switch (target.check(name, value))
+			{
+			case CommandTarget::Check::UnknownSetting:
+				return fmt::format("err unknown setting {}", name);
+			case CommandTarget::Check::InvalidValue:
+				return fmt::format("err invalid value for {}: {}", name, value);
+			case CommandTarget::Check::Valid:
+				break;
+			}
+
+			values.emplace_back(name, value);
+		}
+
+		if (values.empty())
+			return "err usage: set Section.Key=value [...]";
+
+		target.set(values);
+		return "ok";
+	}
+
+	if (ini::iequals(verb, "list"))
+	{
+		std::string reply = "ok";
+		for (const auto& [name, value] : target.list())
+			reply += fmt::format("\n{}={}", name, value);
+		return reply;
+	}
+
+	if (ini::iequals(verb, "reload"))
+	{
+		return target.reload() ? "ok" : "err failed to read INIs";
+	}
+
+	if (ini::iequals(verb, "stats"))
+	{
+		return "ok " + target.stats();
+	}
+
+	return fmt::format("err unknown command {}", verb);
+}
+};
@@ -0,0 +1,39 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Text commands accepted by the control pipe, split out from the pipe itself so they only work on plain strings
+// Kept free of any Win32/NGX dependencies so it can also be built on other platforms
+namespace control
+{
+// Whatever the commands act on, ControlChannel.cpp implements this on top of UserSettings & the settings schema
+// Settings are named Section.Key, values use the same format as the INI
+class CommandTarget
+{
+public:
+	enum class Check
+	{
+		Valid,
+		UnknownSetting,
+		InvalidValue,
+	};
+
+	virtual ~CommandTarget() = default;
+
+	// Returns false if there's no setting with that name
+	virtual bool get(std::string_view name, std::string& value) const = 0;
+	// Every setting in schema order, all read from the same snapshot
+	virtual std::vector<std::pair<std::string, std::string>> list() const = 0;
+	virtual Check check(std::string_view name, std::string_view value) const = 0;
+	// Only called once every value has passed check(), applies them all together
+	virtual void set(const std::vector<std::pair<std::string_view, std::string_view>>& values) = 0;
+	virtual bool reload() = 0;
+	// Space-separated name=value counters
+	virtual std::string stats() const = 0;
+};
+
+// Runs a single command line & returns the reply, independent of whichever transport delivered it
+std::string execute(std::string_view command, CommandTarget& target);
+};
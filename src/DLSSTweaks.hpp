@@ -1,21 +1,21 @@
 #pragma once
 #include <SafetyHook.hpp>
 #include "Utility.hpp"
+#include <array>
+#include <atomic>
 #include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 #include <nvsdk_ngx_defs.h>
 #include <nvsdk_ngx_params.h>
 
-// Certain settings which aren't currently included in DLSS SDK, but do seem checked by DLSS 3.1+ DLL files.
-#ifndef NVSDK_NGX_Parameter_Disable_Watermark
-#define NVSDK_NGX_Parameter_Disable_Watermark "Disable.Watermark"
-#endif
-#ifndef NVSDK_NGX_Parameter_DLSS_Get_Dynamic
-#define NVSDK_NGX_Parameter_DLSS_Get_Dynamic "DLSS.Get.Dynamic."
-#endif
-
-constexpr float DLSS_MinScale = 0.0f;
-constexpr float DLSS_MaxScale = 1.0f;
+#include "NgxDefs.hpp"
 
 struct DlssNvidiaPresetOverrides
 {
@@ -28,28 +28,16 @@ struct DlssNvidiaPresetOverrides
 	void zero_customized_values();
 };
 
-struct QualityLevel
-{
-	std::string name;
-	float scalingRatio;
-	std::pair<int, int> resolution = { 0,0 };
-
-	// The last resolution we told game about for the this level, so we can check against it later on
-	// (based on either `scalingRatio` or `resolution` set by the user)
-	std::pair<int, int> currentResolution = { 0,0 };
-
-	unsigned int preset = NVSDK_NGX_DLSS_Hint_Render_Preset_Default;
-
-	std::string lastUserValue = "";
-};
-
 struct DlssSettings
 {
 	NVSDK_NGX_PerfQuality_Value prevQualityLevel; // the last quality level setting that game requested
+	ReportedResolutions reportedResolutions{}; // written by GetUI, checked when DLSS picks a preset
 	std::optional<ID3D12Resource*> prevExposureTexture;
 
 	int featureCreateFlags = 0;
 	std::optional<DlssNvidiaPresetOverrides> nvidiaOverrides;
+	// IDs are written by the NGX init hooks on game threads & read by profile matching on the service thread, hold idMutex for either
+	mutable std::mutex idMutex;
 	unsigned long long appId = 0;
 	std::string projectId;
 
@@ -60,54 +48,254 @@ struct DlssSettings
 	}
 };
 
+// Hot-path components that cache or depend on user settings, each schema entry lists which of these need to know when it changes
+namespace subsystem
+{
+constexpr uint32_t None = 0;
+constexpr uint32_t LogLevel = 1 << 0;
+constexpr uint32_t Watermark = 1 << 1; // nvngx_dlssg DisableDevWatermark patch
+constexpr uint32_t DlssHud = 1 << 2; // ShowDlssIndicator registry hooks
+constexpr uint32_t ResolutionTable = 1 << 3; // GetUI resolution overrides / DLAA / dynamic res
+constexpr uint32_t PresetTable = 1 << 4; // render preset overrides
+constexpr uint32_t FeatureFlags = 1 << 5; // CreateFeature flags (HDR/auto-exposure/alpha) & sharpening
+constexpr uint32_t AppId = 1 << 6;
+constexpr uint32_t IniMonitoring = 1 << 7;
+constexpr uint32_t DllOverrides = 1 << 8;
+constexpr uint32_t ControlPipe = 1 << 9;
+constexpr uint32_t ThreadPolicy = 1 << 10;
+};
+
+struct SettingDef; // SettingsSchema.hpp
+struct IniLayer; // UserSettings.cpp
+
 struct UserSettings
 {
 	bool disableAllTweaks = false; // not exposed in INI, is set if a serious error is detected (eg. two versions loaded at once)
 
-	std::unordered_map<NVSDK_NGX_PerfQuality_Value, QualityLevel> qualities =
-	{
-		{NVSDK_NGX_PerfQuality_Value_UltraPerformance, {"UltraPerformance", 0.33333334f}},
-		{NVSDK_NGX_PerfQuality_Value_MaxPerf, {"Performance", 0.5f}},
-		{NVSDK_NGX_PerfQuality_Value_Balanced, {"Balanced", 0.58f}},
-		{NVSDK_NGX_PerfQuality_Value_MaxQuality, {"Quality", 0.66666667f}},
-		{NVSDK_NGX_PerfQuality_Value_DLAA, {"DLAA", 1.0f}},
-
-		// note: if NVSDK_NGX_PerfQuality_Value_UltraQuality is non-zero, some games may detect that we're passing a valid resolution and show an Ultra Quality option as a result
-		// very few games support this though, and right now DLSS seems to refuse to render if UltraQuality gets passed to it
-		// our SetI hook in HooksNvngx can override the quality passed to DLSS if this gets used by the game, letting it think this is MaxQuality instead
-		// but we'll only do that if user has overridden this in the INI to a non-zero value
-		{NVSDK_NGX_PerfQuality_Value_UltraQuality, {"UltraQuality", 0.f}},
-	};
+	// Default ratios & clamp ranges for these are part of the settings schema
+	// note: if NVSDK_NGX_PerfQuality_Value_UltraQuality is non-zero, some games may detect that we're passing a valid resolution and show an Ultra Quality option as a result
+	// very few games support this though, and right now DLSS seems to refuse to render if UltraQuality gets passed to it
+	// our SetI hook in HooksNvngx can override the quality passed to DLSS if this gets used by the game, letting it think this is MaxQuality instead
+	// but we'll only do that if user has overridden this in the INI to a non-zero value
+	QualityTable qualities;
 
-	bool forceDLAA = false;
-	int overrideAutoExposure = 0;
-	int overrideAlphaUpscaling = 0;
+	// Defaults for all INI-backed fields come from SettingsSchema, applied by reset_to_defaults()
+	bool forceDLAA{};
+	int overrideAutoExposure{};
+	int overrideAlphaUpscaling{};
 	std::optional<float> overrideSharpening{};
-	std::string overrideSharpeningString = "ignore";
-	bool overrideSharpeningForceDisable = false;
-	bool overrideAppId = false;
-	int overrideDlssHud = 0;
-	int overrideHDR = 0;
-	bool disableDevWatermark = false;
-	bool verboseLogging = false;
+	std::string overrideSharpeningString;
+	bool overrideSharpeningForceDisable{};
+	bool overrideAppId{};
+	int overrideDlssHud{};
+	int overrideHDR{};
+	bool disableDevWatermark{};
+	bool verboseLogging{};
 	std::unordered_map<std::string, std::filesystem::path> dllPathOverrides;
-	bool overrideQualityLevels = false;
+	bool overrideQualityLevels{};
+
+	int resolutionOffset{}; // user-defined offset to apply to DLAA / full-res rendering (some titles don't like DLAA rendering at full res, so small offset is needed)
+	bool dynamicResolutionOverride{};
+	int dynamicResolutionMinOffset{};
+	bool disableIniMonitoring{};
+	bool enableControlPipe{};
+	bool prefetchDlls{};
+	bool iatHooks{};
+	bool vtableParamHooks{};
+	int backgroundThreadPriority{}; // threads::Priority, 0 = normal ... 3 = idle
+	bool backgroundThreadEfficiency{};
+
+	// Absolute paths of every INI read so far (including BaseINIs), used to validate the config cache
+	std::vector<std::filesystem::path> iniChain;
+	// BaseINIs that are referenced but don't exist (yet), kept so that creating one gets noticed by the cache & INI watcher
+	std::vector<std::filesystem::path> missingInis;
+	// Stamp of each root INI, BaseINI & the profile database as they were when read (missing ones included), written to the config cache
+	std::vector<std::pair<std::filesystem::path, utility::FileStamp>> iniStamps;
+
+	// Per-game profile database, profiles matching profileExeName/dlss.appId/dlss.projectId are applied on top of the root INIs
+	std::filesystem::path profilesPath;
+	std::string profileExeName;
+	std::vector<std::string> appliedProfiles; // ProfileDb keys used by the last read
+	std::vector<std::filesystem::path> rootInis; // from the last read, so profiles can be reapplied once the app ID is known
+
+	// Bit per SettingsSchema entry, set whenever that field's value actually changes (cleared by take_changes)
+	uint64_t changedFields = 0;
+	bool changedDllOverrides = false;
+
+	UserSettings();
 
-	int resolutionOffset = 0; // user-defined offset to apply to DLAA / full-res rendering (some titles don't like DLAA rendering at full res, so small offset is needed)
-	bool dynamicResolutionOverride = true;
-	int dynamicResolutionMinOffset = -1;
-	bool disableIniMonitoring = false;
+	// Rebuilds settings from defaults + each root INI in order (with their BaseINI chains applied beneath them)
+	// INIs that haven't changed since the last read are re-merged from the layer cache without being read again
+	// Returns false if any INI that exists couldn't be read, leaving settings untouched
+	bool read(const std::vector<std::filesystem::path>& rootInis);
+	// Reads the same root INIs as the last read() again
+	bool reload();
+	// SettingsCache.cpp: loads settings resolved from rootInis by a previous run, if none of the INIs involved have changed since
+	bool read_cache(const std::filesystem::path& cachePath, const std::vector<std::filesystem::path>& rootInis);
+	bool write_cache(const std::filesystem::path& cachePath, const std::vector<std::filesystem::path>& rootInis) const;
+	// Re-reads settings if dlss.appId/projectId match a different set of profiles than the last read, returns true if it did
+	// Posted to the service thread by the NGX init hooks
+	bool reapply_profiles();
+	void reset_to_defaults();
+	// Parses & applies a value for a schema field, returns true if the field changed
+	bool apply_value(const SettingDef& def, std::string_view value);
+	// Checks that apply_value would accept the value as-is, without it falling back to a previous/default value
+	static bool valid_value(const SettingDef& def, std::string_view value);
+	// Applies a batch of values on top of the current settings in one go, without touching any INI (used by the control pipe)
+	// Values set this way only last until the next INI reload
+	void set_values(const std::vector<std::pair<const SettingDef*, std::string_view>>& values);
+	// Current value of a schema field, in the same format the INI uses
+	std::string format_value(const SettingDef& def) const;
+	// Returns the subsystem mask for every field changed since the last call, & clears the changed state
+	uint32_t take_changes();
+	// Returns bit per SettingsSchema entry that differs between the two
+	uint64_t diff(const UserSettings& other) const;
+	// Notifies subscribers of any changes since the last call (only those depending on changed fields), returns the changed mask
+	uint32_t dispatch_changes();
+	void print_to_log() const;
+	// Makes the current values visible through current_settings(), every change made by read/set_values does this itself
+	void publish() const;
+	// IniWatcher.cpp: reloads settings whenever any INI involved (roots, BaseINIs, profile database) is changed
+	// Watcher runs on the service thread, this only queues it up & returns straight away
+	void watch_for_changes(const std::vector<std::filesystem::path>& rootInis);
 
-	bool read(const std::filesystem::path& iniPath, int numInisRead = 0);
-	void print_to_log();
-	void watch_for_changes(const std::filesystem::path& iniPath);
+private:
+	// Swaps in next, publishes it & notifies subscribers about whichever fields changed
+	void commit(UserSettings&& next);
+	bool read_locked(const std::vector<std::filesystem::path>& rootInis);
+	bool merge_ini(const std::filesystem::path& iniPath, std::vector<const IniLayer*>& stack);
+	void apply_layer(const IniLayer& layer);
+	bool read_sharpening(std::string_view sharpeningString);
+	bool read_quality_level(QualityLevel& quality, std::string_view value);
+	void read_dll_override(std::string_view dllName, std::string_view pathValue);
 };
 
 // DllMain.cpp / UserSettings.cpp
+// `settings` is the working copy that reads & the control pipe build changes on, only touched while holding the settings lock (or by InitThread before any of those can run)
+// Everything else (hooks on game threads especially) should take current_settings() once per call & read from that instead,
+// it's an immutable copy replaced as a whole by each change, so never shows half of one or gets freed while still being read
 extern UserSettings settings;
 extern DlssSettings dlss;
+std::shared_ptr<const UserSettings> current_settings();
 void WaitForInitThread();
 
+// StartupTrace.cpp
+// Timestamps for each stage between DllMain & the first NGX init, written to the log as a table once init has finished
+// Marks are lock-free & never allocate, so they can be taken from DllMain while the loader lock is held
+namespace startup
+{
+void mark(const char* stage); // stage has to stay valid for the whole process, ie. a string literal
+void log_timeline();
+// Only the first call of each is recorded
+void on_ngx_wait();
+void on_ngx_init();
+};
+
+// IniWatcher.cpp
+// Counters for the INI watcher thread, wakeups should stay near zero while nothing is touching our INIs
+struct IniWatchStats
+{
+	std::atomic<uint64_t> wakeups; // directory notifications received
+	std::atomic<uint64_t> ignoredEvents; // events for files that aren't ours
+	std::atomic<uint64_t> relevantEvents;
+	std::atomic<uint64_t> overflows; // notification buffer overflowed, forcing a reload check
+	std::atomic<uint64_t> reloads;
+	std::atomic<uint64_t> redundantReloads; // INIs were touched but contents didn't change
+};
+extern IniWatchStats iniWatchStats;
+
+// ControlChannel.cpp
+// Local named pipe (\\.\pipe\DLSSTweaks_<pid>) accepting get/set commands, so tools can change settings live without rewriting the INI
+// Off unless Compatibility.EnableControlPipe is set
+namespace control
+{
+// Starts/stops the control pipe to match EnableControlPipe, see ControlCommands.cpp for the commands it accepts
+void settings_changed();
+};
+
+// DllOverrides.cpp
+// Snapshot of DLLPathOverrides for the LoadLibrary hooks, rebuilt whenever the overrides change
+// Lookups compare the filename part of the requested path in-place (case-insensitive), so checking a load that isn't overridden never allocates
+class DllOverrideTable
+{
+public:
+	struct Override
+	{
+		std::wstring name; // case-folded filename
+		std::filesystem::path path;
+		std::wstring widePath;
+	};
+
+	explicit DllOverrideTable(const std::unordered_map<std::string, std::filesystem::path>& overrides);
+
+	const Override* find(std::wstring_view path) const;
+	// Narrow paths are only compared byte-wise, so callers should only use this for plain ASCII names
+	const Override* find(std::string_view path) const;
+
+	bool empty() const { return m_overrides.empty(); }
+	size_t size() const { return m_overrides.size(); }
+
+	// Case-folded filename each watched DLSS module will be loaded under, ie. the override's filename if the user has set one
+	std::wstring_view module_name(size_t module) const { return m_moduleNames[module]; }
+
+private:
+	template <typename CharT> const Override* find_name(std::basic_string_view<CharT> path) const;
+
+	std::array<std::wstring, 4> m_moduleNames; // indexed by dll_overrides::Module - 1
+
+	std::vector<Override> m_overrides;
+	std::vector<uint32_t> m_slots; // open-addressed, index into m_overrides + 1, 0 = empty
+	size_t m_minLength = SIZE_MAX;
+	size_t m_maxLength = 0;
+};
+
+namespace dll_overrides
+{
+// Current table, published atomically so hooks on other threads never see one half-built
+std::shared_ptr<const DllOverrideTable> current();
+void settings_changed();
+
+// Modules that LoaderNotificationCallback watches for
+enum class Module
+{
+	None,
+	Ngx,
+	Dlss,
+	Dlssg,
+	Dlssd,
+};
+// Identifies a newly loaded module from its BaseDllName, overridden DLSS modules are matched by their override filename
+// Runs under the loader lock for every DLL load in the process, so the name is compared in-place without allocating
+Module identify(std::wstring_view baseDllName);
+};
+
+// ServiceThread.cpp
+// Single low-priority thread that all background housekeeping (INI monitoring, debounce/retry timers...) runs on
+// Tasks registered from any thread are always invoked on the service thread, so they don't need to lock against each other
+namespace service
+{
+using Task = std::function<void()>;
+using TimerId = uint64_t;
+
+// Runs the service loop on the calling thread (InitThread, once init has finished) until shutdown() is called
+void run();
+// Asks the service loop to exit without waiting for it, so it's safe to call while holding the loader lock
+// Also used when the loop is never going to be started, so that posts get rejected instead of queueing up forever
+void shutdown();
+
+// Queues task up to run on the service thread, tasks posted before run() starts are picked up once it does
+// Returns false (dropping the task) once the loop has been shut down or has stopped
+bool post(Task task);
+// Runs task after delayMs, then every periodMs if that's non-zero (timers have 10ms granularity)
+TimerId add_timer(uint32_t delayMs, Task task, uint32_t periodMs = 0);
+void cancel_timer(TimerId id);
+// Runs task each time handle is signaled, returns false if too many handles are already registered
+bool add_handle(HANDLE handle, Task task);
+void remove_handle(HANDLE handle);
+// Applies the BackgroundThread* settings to the service thread & any threads started from then on
+void settings_changed();
+};
+
 // HooksNvngx.cpp
 namespace nvngx
 {
@@ -173,3 +361,42 @@ struct HookOrigFn
 		return ((RetT(*)(Args...))dest)(args...);
 	}
 };
+
+// Collects a batch of inline hooks (eg. all exports for a module) so their trampolines can be allocated from one shared block
+// This isn't a transaction: each hook is still written by SafetyHook on its own, which suspends threads & changes page protection every time,
+// & hooks that fail to apply don't undo the ones before them
+class HookBatch
+{
+public:
+	// null targets are skipped, so optional exports can be passed in without needing to check them first
+	template <typename T, typename U> void add(T target, U destination, SafetyHookInline& out)
+	{
+		if (target)
+			m_entries.push_back({ reinterpret_cast<void*>(target), reinterpret_cast<void*>(destination), &out, nullptr });
+	}
+
+	template <typename T, typename U> void add(T target, U destination, HookOrigFn& out)
+	{
+		if (target)
+			m_entries.push_back({ reinterpret_cast<void*>(target), reinterpret_cast<void*>(destination), nullptr, &out });
+	}
+
+	size_t size() const
+	{
+		return m_entries.size();
+	}
+
+	// Applies all the hooks added so far, returns the number of hooks that were created successfully
+	size_t apply();
+
+private:
+	struct Entry
+	{
+		void* target;
+		void* destination;
+		SafetyHookInline* inline_out;
+		HookOrigFn* orig_out;
+	};
+
+	std::vector<Entry> m_entries;
+};
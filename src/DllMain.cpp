@@ -5,54 +5,119 @@
 #include <winternl.h>
 #include <tchar.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
 #include <mutex>
 
-#include <spdlog/spdlog.h>
+#ifndef DLSSTWEAKS_MINIMAL_LOG
+#include <spdlog/details/log_msg_buffer.h>
+#include <spdlog/sinks/base_sink.h>
 #include <spdlog/sinks/msvc_sink.h>
 #include <spdlog/sinks/basic_file_sink.h>
-#include <ini.h>
+#endif
 
 #include "DLSSTweaks.hpp"
+#include "Log.hpp"
+#include "Prefetch.hpp"
 #include "Proxy.hpp"
+#include "ThreadPolicy.hpp"
 
 #include "resource.h" // TWEAKS_VER_STR
 
-const wchar_t* NgxFileName = L"_nvngx.dll";
-const wchar_t* DlssFileName = L"nvngx_dlss.dll";
-const char* DlssFileNameA = "nvngx_dlss.dll";
-const wchar_t* DlssgFileName = L"nvngx_dlssg.dll";
-const char* DlssgFileNameA = "nvngx_dlssg.dll";
-const wchar_t* DlssdFileName = L"nvngx_dlssd.dll";
-const char* DlssdFileNameA = "nvngx_dlssd.dll";
-
 const wchar_t* LogFileName = L"dlsstweaks.log";
 const wchar_t* IniFileName = L"dlsstweaks.ini";
+const wchar_t* CacheFileName = L"dlsstweaks.cache";
+const wchar_t* ProfilesFileName = L"dlsstweaks_profiles.ini";
 const wchar_t* ErrorFileName = L"dlsstweaks_error.log";
 
 std::filesystem::path ExePath;
 std::filesystem::path DllPath;
 std::filesystem::path LogPath;
 std::filesystem::path IniPath;
+std::vector<std::filesystem::path> IniPaths; // DLL INI (if different folder) & EXE INI, in the order they're applied
 
 UserSettings settings;
 DlssSettings dlss;
 
-std::mutex initThreadFinishedMutex;
-std::condition_variable initThreadFinishedVar;
-bool initThreadFinished = false;
+// Set once InitThread has read settings & registered the hooks NGX depends on, the rest of init carries on after this
+std::atomic<bool> settingsReady = false;
+
+void SignalSettingsReady()
+{
+	settingsReady.store(true, std::memory_order_release);
+	settingsReady.notify_all();
+}
 
 // In nvngx.dll wrapper mode the game might call DLSS functions immediately after loading DLL (ie. right after DllMain)
 // before our InitThread has actually finished reading settings etc
-// This func will just check if finished & wait for it if not, seems to be safe to let the NVNGX calls wait for this
+// This func will just check if settings are ready & wait for them if not, seems to be safe to let the NVNGX calls wait for this
 void WaitForInitThread()
 {
-	if (initThreadFinished)
+	// Acquire pairs with the release in SignalSettingsReady, so everything InitThread wrote before it is visible here
+	if (settingsReady.load(std::memory_order_acquire))
 		return;
 
-	std::unique_lock lock(initThreadFinishedMutex);
-	initThreadFinishedVar.wait(lock, [] { return initThreadFinished; });
+	startup::on_ngx_wait();
+	while (!settingsReady.load(std::memory_order_acquire))
+		settingsReady.wait(false, std::memory_order_acquire);
 }
 
+#ifndef DLSSTWEAKS_MINIMAL_LOG
+// Keeps log messages in memory until InitThread gets around to opening the log file, then writes them out in order & passes everything after through
+// Opening the file can take a while (AV scanners etc), so it's left until after settingsReady instead of holding up NGX calls
+class DeferredFileSink : public spdlog::sinks::base_sink<std::mutex>
+{
+public:
+	void open(const std::filesystem::path& path)
+	{
+		std::shared_ptr<spdlog::sinks::basic_file_sink_st> file;
+		try
+		{
+			file = std::make_shared<spdlog::sinks::basic_file_sink_st>(path.string(), true);
+		}
+		catch (const std::exception&)
+		{
+			// spdlog failed to open log file for writing (happens in some WinStore apps)
+			// let's just try to continue instead of crashing
+		}
+
+		std::lock_guard lock(mutex_);
+		m_file = std::move(file);
+		m_opened = true;
+
+		if (m_file)
+		{
+			for (const auto& msg : m_pending)
+				m_file->log(msg);
+			m_file->flush();
+		}
+		m_pending.clear();
+		m_pending.shrink_to_fit();
+	}
+
+protected:
+	void sink_it_(const spdlog::details::log_msg& msg) override
+	{
+		if (!m_opened)
+			m_pending.emplace_back(msg);
+		else if (m_file)
+			m_file->log(msg);
+	}
+
+	void flush_() override
+	{
+		if (m_file)
+			m_file->flush();
+	}
+
+private:
+	std::shared_ptr<spdlog::sinks::basic_file_sink_st> m_file;
+	std::vector<spdlog::details::log_msg_buffer> m_pending;
+	bool m_opened = false;
+};
+#endif
+
 // LoadLibraryXXX hook so we can redirect DLSS library load to users choice
 SafetyHookInline LoadLibraryExW_Orig;
 SafetyHookInline LoadLibraryExA_Orig;
@@ -60,38 +125,61 @@ SafetyHookInline LoadLibraryA_Orig;
 SafetyHookInline LoadLibraryW_Orig;
 
 std::once_flag dlssOverrideMessage;
-HMODULE __stdcall LoadLibraryExW_Hook(LPCWSTR lpLibFileName, HANDLE hFile, DWORD dwFlags)
+
+// Path to load instead of the requested one, or nullptr to carry on with the original
+const wchar_t* OverridePath(const DllOverrideTable::Override& match, const std::filesystem::path& requestedPath)
 {
-	std::filesystem::path libPath = lpLibFileName;
-	const auto filenameStr = libPath.filename().string();
+	spdlog::info("DLLPathOverrides: redirecting {} to new path {}", requestedPath.string(), match.path.string());
 
-	// Check if filename matches any DLL user has requested to override, change to the user-specified path if so
-	for (auto& [overrideDllName, overridePath] : settings.dllPathOverrides)
-	{
-		if (_stricmp(filenameStr.c_str(), overrideDllName.c_str()) != 0)
-			continue;
+	if (utility::exists_safe(match.path))
+		return match.widePath.c_str();
 
-		if (!overridePath.empty())
-		{
-			spdlog::info("DLLPathOverrides: redirecting {} to new path {}", libPath.string(), overridePath.string());
+	spdlog::error("DLLPathOverrides: override DLL no longer exists, skipping... (path: {})", match.path.string());
+	return nullptr;
+}
 
-			if (utility::exists_safe(overridePath))
-				libPath = overridePath;
-			else
-				spdlog::error("DLLPathOverrides: override DLL no longer exists, skipping... (path: {})", overridePath.string());
-		}
-		break;
+HMODULE __stdcall LoadLibraryExW_Hook(LPCWSTR lpLibFileName, HANDLE hFile, DWORD dwFlags)
+{
+	// Every library load in the process passes through here, so loads that aren't overridden are passed on as-is without any copying
+	// (table reference also keeps the override path alive if settings get reloaded mid-call)
+	const auto table = dll_overrides::current();
+	const auto* match = (table && lpLibFileName) ? table->find(std::wstring_view(lpLibFileName)) : nullptr;
+	if (match)
+	{
+		if (const wchar_t* overridePath = OverridePath(*match, lpLibFileName))
+			return LoadLibraryExW_Orig.stdcall<HMODULE>(overridePath, hFile, dwFlags);
 	}
 
-	const std::wstring libPathStr = libPath.wstring();
-	return LoadLibraryExW_Orig.stdcall<HMODULE>(libPathStr.c_str(), hFile, dwFlags);
+	return LoadLibraryExW_Orig.stdcall<HMODULE>(lpLibFileName, hFile, dwFlags);
 }
 
 HMODULE __stdcall LoadLibraryExA_Hook(LPCSTR lpLibFileName, HANDLE hFile, DWORD dwFlags)
 {
-	const std::filesystem::path libPath = lpLibFileName;
-	const auto libPathStr = libPath.wstring();
-	return LoadLibraryExW_Hook(libPathStr.c_str(), hFile, dwFlags);
+	// Narrow names are in the ANSI codepage, where a multibyte char could contain a byte that looks like a path separator
+	// Plain ASCII names (ie. nearly all of them) can be checked in-place, anything else gets converted to wide first like before
+	bool isAscii = lpLibFileName != nullptr;
+	for (const char* c = lpLibFileName; isAscii && *c; c++)
+		isAscii = uint8_t(*c) < 0x80;
+
+	if (!isAscii)
+	{
+		if (!lpLibFileName)
+			return LoadLibraryExA_Orig.stdcall<HMODULE>(lpLibFileName, hFile, dwFlags);
+
+		const std::filesystem::path libPath = lpLibFileName;
+		const auto libPathStr = libPath.wstring();
+		return LoadLibraryExW_Hook(libPathStr.c_str(), hFile, dwFlags);
+	}
+
+	const auto table = dll_overrides::current();
+	const auto* match = table ? table->find(std::string_view(lpLibFileName)) : nullptr;
+	if (match)
+	{
+		if (const wchar_t* overridePath = OverridePath(*match, lpLibFileName))
+			return LoadLibraryExW_Orig.stdcall<HMODULE>(overridePath, hFile, dwFlags);
+	}
+
+	return LoadLibraryExA_Orig.stdcall<HMODULE>(lpLibFileName, hFile, dwFlags);
 }
 
 HMODULE __stdcall LoadLibraryW_Hook(LPCWSTR lpLibFileName)
@@ -112,46 +200,117 @@ HMODULE __stdcall LoadLibraryA_Hook(LPCSTR lpLibFileName)
 void* dll_notification_cookie = nullptr;
 void __stdcall LoaderNotificationCallback(unsigned long notification_reason, const LDR_DLL_NOTIFICATION_DATA* notification_data, void* context)
 {
-	if (notification_reason == LDR_DLL_NOTIFICATION_REASON_LOADED)
+	if (notification_reason != LDR_DLL_NOTIFICATION_REASON_LOADED)
+		return;
+
+	// A module was loaded in, check if NGX/DLSS and apply hooks if so
+	// If user has overridden the nvngx_dlss path, the filename they specified is matched instead
+	const UNICODE_STRING* baseDllName = notification_data->Loaded.BaseDllName;
+	const std::wstring_view dllName(baseDllName->Buffer, baseDllName->Length / sizeof(WCHAR));
+	auto* module = (HMODULE)notification_data->Loaded.DllBase;
+
+	switch (dll_overrides::identify(dllName))
 	{
-		// If user has overridden the nvngx_dlss path, use the filename they specified in our comparisons below
-		std::wstring dlssName = DlssFileName;
-		std::wstring dlssgName = DlssgFileName;
-		std::wstring dlssdName = DlssdFileName;
-
-		if (settings.dllPathOverrides.contains(DlssFileNameA))
-			dlssName = settings.dllPathOverrides[DlssFileNameA].filename().wstring();
-		if (settings.dllPathOverrides.contains(DlssgFileNameA))
-			dlssgName = settings.dllPathOverrides[DlssgFileNameA].filename().wstring();
-		if (settings.dllPathOverrides.contains(DlssdFileNameA))
-			dlssdName = settings.dllPathOverrides[DlssdFileNameA].filename().wstring();
-
-		// A module was loaded in, check if NGX/DLSS and apply hooks if so
-		const std::wstring dllName(notification_data->Loaded.BaseDllName->Buffer, notification_data->Loaded.BaseDllName->Length / sizeof(WCHAR));
-		if (!_wcsicmp(dllName.c_str(), NgxFileName))
-		{
-			nvngx::init((HMODULE)notification_data->Loaded.DllBase);
-		}
-		else if (!_wcsicmp(dllName.c_str(), dlssName.c_str()))
-		{
-			nvngx_dlss::init((HMODULE)notification_data->Loaded.DllBase);
-		}
-		else if (!_wcsicmp(dllName.c_str(), dlssgName.c_str()))
-		{
-			nvngx_dlssg::init((HMODULE)notification_data->Loaded.DllBase);
-		}
-		else if (!_wcsicmp(dllName.c_str(), dlssdName.c_str()))
-		{
-			nvngx_dlssd::init((HMODULE)notification_data->Loaded.DllBase);
-		}
+	case dll_overrides::Module::Ngx:
+		nvngx::init(module);
+		break;
+	case dll_overrides::Module::Dlss:
+		nvngx_dlss::init(module);
+		break;
+	case dll_overrides::Module::Dlssg:
+		nvngx_dlssg::init(module);
+		break;
+	case dll_overrides::Module::Dlssd:
+		nvngx_dlssd::init(module);
+		break;
+	default:
+		break;
 	}
 }
 
 HMODULE ourModule = 0;
 bool attachResult = false;
 
-unsigned int __stdcall InitThread(void* param)
+// DLSS DLLs we'd like in the file cache before the game gets to loading them, skipping any that are already loaded
+std::vector<std::filesystem::path> PrefetchPaths()
 {
+	std::vector<std::filesystem::path> paths;
+	auto add = [&paths](const std::filesystem::path& path) {
+		if (GetModuleHandleW(path.filename().c_str()))
+			return;
+
+		std::error_code ec;
+		if (std::filesystem::is_regular_file(path, ec) && std::find(paths.begin(), paths.end(), path) == paths.end())
+			paths.push_back(path);
+	};
+
+	// _nvngx is what loads the DLSS modules, so it's needed first
+	if (!proxy::is_wrapping_nvngx)
+	{
+		const auto ngxCorePath = proxy_nvngx::ngx_core_path();
+		if (!ngxCorePath.empty())
+			add(ngxCorePath / "_nvngx.dll");
+	}
+
+	// Overridden paths if the user set any, otherwise the copies shipped next to the game EXE
+	// (DLLs that NGX downloaded itself are left alone, their location depends on the driver)
+	const auto table = dll_overrides::current();
+	for (const std::wstring_view name : { L"nvngx_dlss.dll", L"nvngx_dlssg.dll", L"nvngx_dlssd.dll" })
+	{
+		const auto* match = table ? table->find(name) : nullptr;
+		add(match ? match->path : ExePath.parent_path() / name);
+	}
+
+	return paths;
+}
+
+// One-shot thread reading the PrefetchPaths DLLs, so the scans done on first DLSS use don't stall on disk IO
+void PrefetchThread(void* param)
+{
+	const std::unique_ptr<std::vector<std::filesystem::path>> paths((std::vector<std::filesystem::path>*)param);
+
+	// Background mode lowers IO & memory priority along with CPU, so the game's own loading always goes ahead of us
+	SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN);
+
+	LARGE_INTEGER start, end, frequency;
+	QueryPerformanceCounter(&start);
+	const auto stats = prefetch::warm_files(*paths);
+	QueryPerformanceCounter(&end);
+	QueryPerformanceFrequency(&frequency);
+
+	SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_END);
+
+	spdlog::debug("Prefetch: read {}/{} DLL(s), {} bytes in {:.1f}ms", stats.files, paths->size(), stats.bytes,
+		double(end.QuadPart - start.QuadPart) * 1000.0 / double(frequency.QuadPart));
+}
+
+// Plain stdio instead of ofstream, so iostreams don't need to be pulled in just for this
+void WriteErrorFile(const std::filesystem::path& path, const std::string& text)
+{
+	FILE* file = _wfopen(path.c_str(), L"w");
+	if (!file)
+		return;
+
+	fputs(text.c_str(), file);
+	fputs("\r\n", file);
+	fclose(file);
+}
+
+// Opens the log file while InitThread carries on reading INIs, DeferredFileSink holds onto anything logged until it's done
+void LogOpenThread(void* param)
+{
+#ifdef DLSSTWEAKS_MINIMAL_LOG
+	minilog::open_file(LogPath);
+#else
+	((DeferredFileSink*)param)->open(LogPath);
+#endif
+	startup::mark("log file opened");
+}
+
+void InitThread(void* param)
+{
+	startup::mark("InitThread started");
+
 	WCHAR modulePath[4096];
 	GetModuleFileNameW(GetModuleHandleA(0), modulePath, 4096);
 	ExePath = std::filesystem::path(modulePath);
@@ -165,52 +324,45 @@ unsigned int __stdcall InitThread(void* param)
 		std::string warningText =
 			"Warning: multiple versions of DLSSTweaks have attempted to load into the game process.\n\nIf you recently tried to update the DLL, an older version may still be present & loaded in.\n\nCheck your game folder for files such as dxgi.dll / xinput1_3.dll / nvngx.dll and remove any extra versions.";
 
-		try
-		{
-			std::ofstream warningFile(ExePath.parent_path() / ErrorFileName);
-			warningFile << warningText << "\r\n";
-			warningFile.close();
-
-			std::ofstream warningFileDll(DllPath.parent_path() / ErrorFileName);
-			warningFileDll << warningText << "\r\n";
-			warningFileDll.close();
-		}
-		catch (const std::exception&)
-		{
-		}
+		WriteErrorFile(ExePath.parent_path() / ErrorFileName, warningText);
+		WriteErrorFile(DllPath.parent_path() / ErrorFileName, warningText);
 
 		// Skip InitThread if disableAllTweaks was set...
-		{
-			std::lock_guard lock(initThreadFinishedMutex);
-			initThreadFinished = true;
-			initThreadFinishedVar.notify_all();
-		}
+		// (service loop won't be started either, so anything posted to it needs to be rejected)
+		service::shutdown();
+		SignalSettingsReady();
 
-		return 0;
+		return;
 	}
 
-	// spdlog setup
+	// spdlog setup, log file itself is only opened once settingsReady has been signalled
+	// Log is always written next to our DLL
+	LogPath = DllPath.parent_path() / LogFileName;
+#ifdef DLSSTWEAKS_MINIMAL_LOG
+	// MiniLog holds onto messages itself until the file is opened, and writes to the debugger the same way msvc_sink does
+	void* const logOpenParam = nullptr;
+#else
+	const auto logFileSink = std::make_shared<DeferredFileSink>();
 	{
-		// Log is always written next to our DLL
-		LogPath = DllPath.parent_path() / LogFileName;
-
 		std::vector<spdlog::sink_ptr> sinks;
 		sinks.push_back(std::make_shared<spdlog::sinks::msvc_sink_mt>(true));
-		try
-		{
-			sinks.push_back(std::make_shared<spdlog::sinks::basic_file_sink_mt>(LogPath.string(), true));
-		}
-		catch (const std::exception&)
-		{
-			// spdlog failed to open log file for writing (happens in some WinStore apps)
-			// let's just try to continue instead of crashing
-		}
+		sinks.push_back(logFileSink);
 
 		auto combined_logger = std::make_shared<spdlog::logger>("", begin(sinks), end(sinks));
 		combined_logger->set_level(spdlog::level::info);
 		spdlog::set_default_logger(combined_logger);
 		spdlog::flush_on(spdlog::level::debug);
 	}
+	void* const logOpenParam = logFileSink.get();
+#endif
+	startup::mark("logger created");
+
+	proxy::log_unresolved_exports();
+
+	// Nothing else touches the log file, so it can be opened in parallel with reading the INIs
+	threads::Thread logOpenThread;
+	if (!logOpenThread.start(LogOpenThread, logOpenParam))
+		LogOpenThread(logOpenParam);
 
 	spdlog::info("DLSSTweaks v{}, by emoose: {} wrapper loaded", TWEAKS_VER_STR, DllPath.filename().string());
 	spdlog::info("Game path: {}", ExePath.string());
@@ -220,37 +372,37 @@ unsigned int __stdcall InitThread(void* param)
 
 	// Read config from next to DLL first, and then from next to EXE
 	// So with a global injector, you could keep a global config stored next to the DLL, and then per-game overrides kept next to the EXE
+	const auto cachePath = DllPath.parent_path() / CacheFileName;
+	bool cacheOutdated = false;
 	{
 		if (DllPath.parent_path() != ExePath.parent_path())
+			IniPaths.push_back(DllPath.parent_path() / IniFileName);
+		IniPaths.push_back(ExePath.parent_path() / IniFileName);
+
+		// Per-game profiles are kept in a single INI next to the DLL, matched against the EXE name here & the app/project ID once NGX is inited
+		settings.profilesPath = DllPath.parent_path() / ProfilesFileName;
+		settings.profileExeName = ExePath.filename().string();
+
+		// If none of the INIs have changed since last run we can skip parsing them & just load the cached result
+		if (settings.read_cache(cachePath, IniPaths))
 		{
-			IniPath = DllPath.parent_path() / IniFileName;
-			if (utility::exists_safe(IniPath))
-			{
-				if (settings.read(IniPath))
-					spdlog::info("Config read from {}", IniPath.string());
-				else
-					spdlog::error("Failed to read config from {}", IniPath.string());
-			}
+			for (const auto& path : settings.iniChain)
+				spdlog::info("Config read from {} (cached)", path.string());
 		}
-
-		IniPath = ExePath.parent_path() / IniFileName;
-		if (utility::exists_safe(IniPath))
+		else
 		{
-			if (settings.read(IniPath))
-				spdlog::info("Config read from {}", IniPath.string());
-			else
-				spdlog::error("Failed to read config from {}", IniPath.string());
+			if (!settings.read(IniPaths))
+				spdlog::error("Failed to read config, using default settings");
+
+			cacheOutdated = true;
 		}
 
+		IniPath = IniPaths.back();
+		startup::mark("config read");
+
 		// IniPath will point to the INI next to game EXE after this, so that we can monitor any updates to that INI
 	}
 
-	// print msg about wrapping to log here, as nvngx wrap stuff was setup before spdlog was inited
-	if (proxy::is_wrapping_nvngx)
-		spdlog::info("Wrapped nvngx.dll, using funcptrs from original dll");
-	else
-		spdlog::info("Wrapped system DLL, watching for DLSS module load");
-
 	// Register notification so we can learn of DLL loads/unloads
 	auto LdrRegisterDllNotification =
 		(LdrRegisterDllNotificationFunc)GetProcAddress(GetModuleHandle("ntdll.dll"), "LdrRegisterDllNotification");
@@ -263,6 +415,7 @@ unsigned int __stdcall InitThread(void* param)
 	{
 		spdlog::error("Failed to locate LdrRegisterDllNotification function address?"); // shouldn't happen
 	}
+	startup::mark("DLL notification registered");
 
 	// Hook LoadLibrary so we can override DLSS path if desired
 	if (!settings.dllPathOverrides.empty())
@@ -280,24 +433,52 @@ unsigned int __stdcall InitThread(void* param)
 		}
 		else
 		{
-			LoadLibraryExW_Orig = safetyhook::create_inline(LoadLibraryExW_addr, LoadLibraryExW_Hook);
-			LoadLibraryExA_Orig = safetyhook::create_inline(LoadLibraryExA_addr, LoadLibraryExA_Hook);
-			LoadLibraryW_Orig = safetyhook::create_inline(LoadLibraryW_addr, LoadLibraryW_Hook);
-			LoadLibraryA_Orig = safetyhook::create_inline(LoadLibraryA_addr, LoadLibraryA_Hook);
+			HookBatch batch;
+			batch.add(LoadLibraryExW_addr, LoadLibraryExW_Hook, LoadLibraryExW_Orig);
+			batch.add(LoadLibraryExA_addr, LoadLibraryExA_Hook, LoadLibraryExA_Orig);
+			batch.add(LoadLibraryW_addr, LoadLibraryW_Hook, LoadLibraryW_Orig);
+			batch.add(LoadLibraryA_addr, LoadLibraryA_Hook, LoadLibraryA_Orig);
+			batch.apply();
 		}
+		startup::mark("LoadLibrary hooks applied");
 	}
 
-	// Init finished, allow any pending DLSS calls to continue
+	// Settings & the hooks needed to catch DLSS loading are in place, allow any pending DLSS calls to continue
+	// Everything below is only housekeeping, so can carry on while the game is using NGX
+	SignalSettingsReady();
+	startup::mark("settings ready");
+
+	logOpenThread.join();
+
+	// Hooks & the INI watcher can both be changing settings from here on, so only the published snapshot is safe to read
+	const auto current = current_settings();
+
+	if (cacheOutdated)
+		current->write_cache(cachePath, IniPaths);
+
+	// DLLs are read in the background, in case the game hasn't loaded them itself yet
+	if (current->prefetchDlls)
 	{
-		std::lock_guard lock(initThreadFinishedMutex);
-		initThreadFinished = true;
-		initThreadFinishedVar.notify_all();
+		auto paths = std::make_unique<std::vector<std::filesystem::path>>(PrefetchPaths());
+		if (paths->empty())
+			spdlog::debug("Prefetch: no DLLs to read");
+		else if (threads::Thread thread; thread.start(PrefetchThread, paths.get()))
+			paths.release(); // now owned by PrefetchThread
 	}
 
-	if (!settings.disableIniMonitoring)
-		settings.watch_for_changes(IniPath);
+	// print msg about wrapping to log here, as nvngx wrap stuff was setup before spdlog was inited
+	if (proxy::is_wrapping_nvngx)
+		spdlog::info("Wrapped nvngx.dll, using funcptrs from original dll");
+	else
+		spdlog::info("Wrapped system DLL, watching for DLSS module load");
+
+	startup::log_timeline();
 
-	return 0;
+	if (!current->disableIniMonitoring)
+		settings.watch_for_changes(IniPaths);
+
+	// InitThread then becomes the service thread for any background work, instead of us needing a separate thread for each
+	service::run();
 }
 
 HANDLE processUniqueMutex;
@@ -338,24 +519,33 @@ BOOL APIENTRY DllMain(HMODULE hModule, int ul_reason_for_call, LPVOID lpReserved
 	DisableThreadLibraryCalls(hModule);
 	if (ul_reason_for_call == DLL_PROCESS_ATTACH)
 	{
+		startup::mark("DllMain attach");
+
 		ourModule = hModule;
 		attachResult = proxy::on_attach(ourModule);
 		if (proxy::is_wrapping_nvngx)
 			nvngx::init_from_proxy();
+		startup::mark("proxy attached");
 
 		// Check if another instance/version of this module has already loaded in
 		if (CheckDllAlreadyLoaded())
 		{
 			// Disable tweaks to hopefully let game continue...
 			settings.disableAllTweaks = true;
+			settings.publish();
 
 			// We'll alert user to the issue during InitThread, to prevent us from blocking game init
 		}
+		startup::mark("instance check");
 
-		_beginthreadex(NULL, 0, InitThread, NULL, 0, NULL);
+		// InitThread is on the critical path until settings are ready, so it only picks up the background policy once it becomes the service thread
+		threads::Thread initThread;
+		initThread.start(InitThread, nullptr, { threads::Priority::Normal, false });
+		startup::mark("DllMain done");
 	}
 	else if (ul_reason_for_call == DLL_PROCESS_DETACH)
 	{
+		service::shutdown();
 		proxy::on_detach();
 		if (processUniqueMutex)
 			ReleaseMutex(processUniqueMutex);
@@ -0,0 +1,170 @@
+#include <atomic>
+#include <memory>
+
+#include "DLSSTweaks.hpp"
+#include "Log.hpp"
+
+namespace
+{
+// Default filenames for each dll_overrides::Module
+constexpr std::array<std::wstring_view, 4> DefaultModuleNames =
+{
+	L"_nvngx.dll",
+	L"nvngx_dlss.dll",
+	L"nvngx_dlssg.dll",
+	L"nvngx_dlssd.dll",
+};
+
+// DLL names are compared the same way _stricmp did before, folding ASCII only
+constexpr wchar_t fold(wchar_t c)
+{
+	return (c >= L'A' && c <= L'Z') ? wchar_t(c - L'A' + L'a') : c;
+}
+
+template <typename CharT>
+constexpr uint32_t hash_name(std::basic_string_view<CharT> name)
+{
+	uint32_t hash = 0x811c9dc5u;
+	for (const CharT c : name)
+	{
+		const wchar_t folded = fold(wchar_t(std::make_unsigned_t<CharT>(c)));
+		hash ^= uint32_t(folded);
+		hash *= 0x01000193u;
+	}
+	return hash;
+}
+
+// Filename part of a path, same separators std::filesystem accepts on Windows
+template <typename CharT>
+constexpr std::basic_string_view<CharT> filename_of(std::basic_string_view<CharT> path)
+{
+	for (size_t i = path.size(); i > 0; i--)
+	{
+		const CharT c = path[i - 1];
+		if (c == CharT('\\') || c == CharT('/') || c == CharT(':'))
+			return path.substr(i);
+	}
+	return path;
+}
+
+// Length is checked first, so most names are rejected without looking at a single character
+template <typename CharT>
+bool matches(std::basic_string_view<CharT> name, std::wstring_view foldedName)
+{
+	if (name.size() != foldedName.size())
+		return false;
+	for (size_t i = 0; i < name.size(); i++)
+		if (fold(wchar_t(std::make_unsigned_t<CharT>(name[i]))) != foldedName[i])
+			return false;
+	return true;
+}
+
+std::atomic<std::shared_ptr<const DllOverrideTable>> currentTable;
+};
+
+DllOverrideTable::DllOverrideTable(const std::unordered_map<std::string, std::filesystem::path>& overrides)
+{
+	for (const auto& [dllName, path] : overrides)
+	{
+		// Empty path only exists to clear an override from a BaseINI, so there's nothing to redirect
+		if (path.empty())
+			continue;
+
+		Override entry;
+		entry.name = std::filesystem::path(std::u8string_view((const char8_t*)dllName.data(), dllName.size())).wstring();
+		for (auto& c : entry.name)
+			c = fold(c);
+		entry.path = path;
+		entry.widePath = path.wstring();
+
+		m_minLength = std::min(m_minLength, entry.name.size());
+		m_maxLength = std::max(m_maxLength, entry.name.size());
+		m_overrides.push_back(std::move(entry));
+	}
+
+	// Power-of-two table kept at most half full, so a miss usually ends on the first empty slot
+	size_t numSlots = 4;
+	while (numSlots < m_overrides.size() * 2)
+		numSlots *= 2;
+	m_slots.resize(numSlots);
+
+	for (size_t i = 0; i < m_overrides.size(); i++)
+	{
+		size_t slot = hash_name(std::wstring_view(m_overrides[i].name)) & (numSlots - 1);
+		while (m_slots[slot])
+			slot = (slot + 1) & (numSlots - 1);
+		m_slots[slot] = uint32_t(i + 1);
+	}
+
+	// Precomputed here so the loader callback doesn't need to look anything up per load
+	// (_nvngx itself is never redirected by us, only the DLSS modules it loads)
+	for (size_t i = 0; i < DefaultModuleNames.size(); i++)
+	{
+		const Override* match = i > 0 ? find(DefaultModuleNames[i]) : nullptr;
+		if (match)
+			m_moduleNames[i] = match->path.filename().wstring();
+		else
+			m_moduleNames[i] = DefaultModuleNames[i];
+
+		for (auto& c : m_moduleNames[i])
+			c = fold(c);
+	}
+}
+
+template <typename CharT>
+const DllOverrideTable::Override* DllOverrideTable::find_name(std::basic_string_view<CharT> path) const
+{
+	const auto name = filename_of(path);
+
+	// Length check rules out most loads before the name is even hashed
+	if (m_overrides.empty() || name.size() < m_minLength || name.size() > m_maxLength)
+		return nullptr;
+
+	const size_t mask = m_slots.size() - 1;
+	for (size_t slot = hash_name(name) & mask; m_slots[slot]; slot = (slot + 1) & mask)
+	{
+		const Override& entry = m_overrides[m_slots[slot] - 1];
+		if (matches(name, entry.name))
+			return &entry;
+	}
+	return nullptr;
+}
+
+const DllOverrideTable::Override* DllOverrideTable::find(std::wstring_view path) const
+{
+	return find_name(path);
+}
+
+const DllOverrideTable::Override* DllOverrideTable::find(std::string_view path) const
+{
+	return find_name(path);
+}
+
+namespace dll_overrides
+{
+std::shared_ptr<const DllOverrideTable> current()
+{
+	return currentTable.load(std::memory_order_acquire);
+}
+
+Module identify(std::wstring_view baseDllName)
+{
+	// Might run before the first settings publish, the default names still apply then
+	const auto table = current();
+	for (size_t i = 0; i < DefaultModuleNames.size(); i++)
+	{
+		const std::wstring_view name = table ? table->module_name(i) : DefaultModuleNames[i];
+		if (matches(baseDllName, name))
+			return Module(i + 1);
+	}
+	return Module::None;
+}
+
+void settings_changed()
+{
+	// Hooks might be using the previous table right now, they keep it alive through their own reference until they're done
+	auto table = std::make_shared<const DllOverrideTable>(current_settings()->dllPathOverrides);
+	spdlog::debug("DLLPathOverrides: {} override(s) active", table->size());
+	currentTable.store(std::move(table), std::memory_order_release);
+}
+};
@@ -0,0 +1,40 @@
+#define WIN32_LEAN_AND_MEAN
+#define WIN32_NO_STATUS
+#include <Windows.h>
+
+#include <algorithm>
+
+#include "DLSSTweaks.hpp"
+
+size_t HookBatch::apply()
+{
+	if (m_entries.empty())
+		return 0;
+
+	// Hook in address order so trampolines end up laid out next to each other inside the allocator block
+	std::sort(m_entries.begin(), m_entries.end(), [](const Entry& a, const Entry& b) {
+		return uintptr_t(a.target) < uintptr_t(b.target);
+	});
+
+	// Fresh allocator for this batch, first allocation reserves a block near the targets which the rest of the trampolines then share
+	auto allocator = safetyhook::Allocator::create();
+
+	// SafetyHook suspends other threads & changes page protection itself while writing each hook
+	size_t numApplied = 0;
+	for (auto& entry : m_entries)
+	{
+		auto hook = safetyhook::InlineHook::create(allocator, entry.target, entry.destination);
+		if (!hook)
+			continue;
+
+		if (entry.inline_out)
+			*entry.inline_out = std::move(*hook);
+		else if (entry.orig_out)
+			*entry.orig_out = std::move(*hook);
+
+		numApplied++;
+	}
+
+	m_entries.clear();
+	return numApplied;
+}
@@ -0,0 +1,128 @@
+#include <cmath>
+#include <cstdlib>
+
+#include "HookLogic.hpp"
+#include "IniParser.hpp"
+#include "UtilityParse.hpp"
+
+namespace hook_logic
+{
+namespace
+{
+int apply_tristate(int flags, int setting, int flag)
+{
+	if (setting >= 1)
+		return flags | flag;
+	if (setting < 0)
+		return flags & ~flag;
+	return flags;
+}
+
+// Within 1 pixel of each other either way
+bool resolution_close(std::pair<int, int> a, std::pair<int, int> b)
+{
+	return abs(a.first - b.first) <= 1 && abs(a.second - b.second) <= 1;
+}
+};
+
+int override_feature_flags(int flags, const FeatureFlagOverrides& overrides)
+{
+	flags = apply_tristate(flags, overrides.hdr, NVSDK_NGX_DLSS_Feature_Flags_IsHDR);
+	flags = apply_tristate(flags, overrides.autoExposure, NVSDK_NGX_DLSS_Feature_Flags_AutoExposure);
+	flags = apply_tristate(flags, overrides.alphaUpscaling, NVSDK_NGX_DLSS_Feature_Flags_AlphaUpscaling);
+
+	if (overrides.sharpeningForceDisable)
+		flags &= ~NVSDK_NGX_DLSS_Feature_Flags_DoSharpening;
+	else if (overrides.sharpeningOverride)
+		flags |= NVSDK_NGX_DLSS_Feature_Flags_DoSharpening;
+
+	return flags;
+}
+
+int dlss_quality_value(int requested, const QualityLevel& ultraQuality)
+{
+	if (requested == int(NVSDK_NGX_PerfQuality_Value_UltraQuality))
+	{
+		if (utility::ValidResolution(ultraQuality.resolution) || ultraQuality.scalingRatio > 0.f)
+			return int(NVSDK_NGX_PerfQuality_Value_MaxQuality);
+	}
+	return requested;
+}
+
+ResolutionQuery classify_resolution_query(std::string_view name, bool dynamicResolutionOverride)
+{
+	ResolutionQuery query;
+	query.dynamic = dynamicResolutionOverride && name.starts_with(NVSDK_NGX_Parameter_DLSS_Get_Dynamic);
+
+	const bool dynamicMinWidth = query.dynamic && ini::iequals(name, NVSDK_NGX_Parameter_DLSS_Get_Dynamic_Min_Render_Width);
+	const bool dynamicMinHeight = query.dynamic && ini::iequals(name, NVSDK_NGX_Parameter_DLSS_Get_Dynamic_Min_Render_Height);
+	query.dynamicMin = dynamicMinWidth || dynamicMinHeight;
+
+	query.width = ini::iequals(name, NVSDK_NGX_Parameter_OutWidth) ||
+		(query.dynamic && (dynamicMinWidth || ini::iequals(name, NVSDK_NGX_Parameter_DLSS_Get_Dynamic_Max_Render_Width)));
+
+	query.height = ini::iequals(name, NVSDK_NGX_Parameter_OutHeight) ||
+		(query.dynamic && (dynamicMinHeight || ini::iequals(name, NVSDK_NGX_Parameter_DLSS_Get_Dynamic_Max_Render_Height)));
+
+	return query;
+}
+
+std::pair<unsigned int, unsigned int> render_resolution(const QualityLevel& quality, unsigned int targetWidth, unsigned int targetHeight, int resolutionOffset)
+{
+	// calculate width/height from custom ratio
+	unsigned int renderWidth = (unsigned int)(roundf(float(targetWidth) * quality.scalingRatio));
+	unsigned int renderHeight = (unsigned int)(roundf(float(targetHeight) * quality.scalingRatio));
+
+	// ..but if custom res is set for this level, override it with that
+	if (utility::ValidResolution(quality.resolution))
+	{
+		renderWidth = quality.resolution.first;
+		renderHeight = quality.resolution.second;
+	}
+
+	if (renderWidth >= targetWidth)
+	{
+		renderWidth = targetWidth; // DLSS can't render above the target res
+		renderWidth += resolutionOffset; // apply resolutionOffset compatibility hack
+	}
+	if (renderHeight >= targetHeight)
+	{
+		renderHeight = targetHeight; // DLSS can't render above the target res
+		renderHeight += resolutionOffset; // apply resolutionOffset compatibility hack
+	}
+
+	return { renderWidth, renderHeight };
+}
+
+PresetSelection select_preset(const QualityTable& qualities, const ReportedResolutions& reported, std::pair<int, int> renderResolution, std::pair<int, int> displayResolution)
+{
+	PresetSelection selection;
+
+	// Only the first level with a matching resolution is checked, even if it doesn't have a preset set
+	for (const auto& [level, quality] : qualities)
+	{
+		if (resolution_close(reported[size_t(level)], renderResolution))
+		{
+			if (quality.preset != NVSDK_NGX_DLSS_Hint_Render_Preset_Default)
+			{
+				selection.preset = quality.preset;
+				selection.quality = &quality;
+				selection.resolution = reported[size_t(level)];
+			}
+			break;
+		}
+	}
+
+	if (selection.preset != NVSDK_NGX_DLSS_Hint_Render_Preset_Default)
+		return selection;
+
+	// No match found for DLSS presets, check whether this could be DLAA
+	const unsigned int presetDLAA = qualities[NVSDK_NGX_PerfQuality_Value_DLAA].preset;
+	if (presetDLAA != NVSDK_NGX_DLSS_Hint_Render_Preset_Default && resolution_close(displayResolution, renderResolution))
+	{
+		selection.preset = presetDLAA;
+		selection.dlaa = true;
+	}
+	return selection;
+}
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <string_view>
+#include <utility>
+
+#include "NgxDefs.hpp"
+
+// Decisions made by the NGX parameter & DLSS creation hooks, split out from the hooks themselves so they only work on plain values
+// Kept free of any Win32 dependencies so it can also be built on other platforms
+namespace hook_logic
+{
+// Settings that change the flags passed to CreateFeature
+// Tri-states are 0 to leave the flag alone, >= 1 to force enable, < 0 to force disable
+struct FeatureFlagOverrides
+{
+	int hdr = 0;
+	int autoExposure = 0;
+	int alphaUpscaling = 0;
+	bool sharpeningForceDisable = false;
+	bool sharpeningOverride = false; // OverrideSharpening has a value, so DLSS needs sharpening enabled for it to be used
+};
+
+// Returns the feature flags that should be passed to DLSS instead of `flags`
+int override_feature_flags(int flags, const FeatureFlagOverrides& overrides);
+
+// Quality value to pass on to DLSS for the one the game set
+// UltraQuality is swapped for MaxQuality if we were the ones that made it available, DLSS itself doesn't like being asked for it
+int dlss_quality_value(int requested, const QualityLevel& ultraQuality);
+
+// Which of the resolution outputs (if any) a GetUI call is asking for
+struct ResolutionQuery
+{
+	bool width = false;
+	bool height = false;
+	bool dynamic = false; // DLSS.Get.Dynamic.* query, only when DynamicResolutionOverride is enabled
+	bool dynamicMin = false;
+};
+ResolutionQuery classify_resolution_query(std::string_view name, bool dynamicResolutionOverride);
+
+// Render resolution to report for a quality level, from its ratio or custom resolution
+// Clamped to the target resolution (plus ResolutionOffset) since DLSS can't render above it
+std::pair<unsigned int, unsigned int> render_resolution(const QualityLevel& quality, unsigned int targetWidth, unsigned int targetHeight, int resolutionOffset);
+
+struct PresetSelection
+{
+	unsigned int preset = NVSDK_NGX_DLSS_Hint_Render_Preset_Default; // Default if DLSS should be left to pick
+	const QualityLevel* quality = nullptr; // level the render resolution matched, nullptr if matched as DLAA (or not at all)
+	std::pair<int, int> resolution = { 0,0 }; // resolution reported for that level
+	bool dlaa = false;
+};
+
+// Picks the preset for a DLSS instance from the render resolution, by checking which quality level we last reported that resolution for
+// Falls back to the DLAA preset if the render resolution is the display resolution
+PresetSelection select_preset(const QualityTable& qualities, const ReportedResolutions& reported, std::pair<int, int> renderResolution, std::pair<int, int> displayResolution);
+};
@@ -0,0 +1,110 @@
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "IniParser.hpp"
+
+namespace ini
+{
+#ifdef _WIN32
+bool MappedFile::open(const std::filesystem::path& path)
+{
+	close();
+
+	HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size{};
+	if (!GetFileSizeEx(file, &size) || size.QuadPart < 0 || uint64_t(size.QuadPart) > SIZE_MAX)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	// Can't create a mapping for empty files, but they're still valid INIs
+	if (size.QuadPart == 0)
+	{
+		CloseHandle(file);
+		m_open = true;
+		return true;
+	}
+
+	HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(file);
+	if (!mapping)
+		return false;
+
+	// View keeps the mapping alive by itself, no need to hold onto either handle
+	void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (!data)
+		return false;
+
+	m_data = (const char*)data;
+	m_size = size_t(size.QuadPart);
+	m_open = true;
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (m_data)
+		UnmapViewOfFile(m_data);
+
+	m_data = nullptr;
+	m_size = 0;
+	m_open = false;
+}
+#else
+bool MappedFile::open(const std::filesystem::path& path)
+{
+	close();
+
+	const int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat st {};
+	if (fstat(fd, &st) != 0 || st.st_size < 0)
+	{
+		::close(fd);
+		return false;
+	}
+
+	if (st.st_size == 0)
+	{
+		::close(fd);
+		m_open = true;
+		return true;
+	}
+
+	void* data = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (data == MAP_FAILED)
+		return false;
+
+	m_data = (const char*)data;
+	m_size = size_t(st.st_size);
+	m_open = true;
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (m_data)
+		munmap((void*)m_data, m_size);
+
+	m_data = nullptr;
+	m_size = 0;
+	m_open = false;
+}
+#endif
+};
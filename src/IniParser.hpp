@@ -0,0 +1,221 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <charconv>
+#include <filesystem>
+#include <string_view>
+#include <utility>
+
+// Small streaming INI parser, works directly on top of the file contents without copying anything into std::string/std::map containers
+// Each key/value pair found is handed to a callback as string_views into the original text, so parsing doesn't need to allocate at all
+// (kept free of any Win32/NGX dependencies so it can also be built on other platforms)
+namespace ini
+{
+// Read-only memory-mapped view of a file
+// Mapping should only be kept alive while parsing, as Windows won't let editors truncate the file while a view of it is open
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	explicit MappedFile(const std::filesystem::path& path) { open(path); }
+	~MappedFile() { close(); }
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	MappedFile(MappedFile&& other) noexcept
+	{
+		*this = std::move(other);
+	}
+
+	MappedFile& operator=(MappedFile&& other) noexcept
+	{
+		if (this != &other)
+		{
+			close();
+			m_data = other.m_data;
+			m_size = other.m_size;
+			m_open = other.m_open;
+			other.m_data = nullptr;
+			other.m_size = 0;
+			other.m_open = false;
+		}
+		return *this;
+	}
+
+	bool open(const std::filesystem::path& path);
+	void close();
+
+	bool is_open() const { return m_open; }
+	std::string_view view() const { return { m_data, m_size }; }
+
+private:
+	const char* m_data = nullptr;
+	size_t m_size = 0;
+	bool m_open = false; // empty files are valid but have no mapping
+};
+
+struct Entry
+{
+	std::string_view section;
+	std::string_view key;
+	std::string_view value;
+	size_t line;
+};
+
+inline constexpr bool is_space(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+inline constexpr char to_lower(char c)
+{
+	return (c >= 'A' && c <= 'Z') ? char(c - 'A' + 'a') : c;
+}
+
+inline constexpr std::string_view trim(std::string_view str)
+{
+	while (!str.empty() && is_space(str.front()))
+		str.remove_prefix(1);
+	while (!str.empty() && is_space(str.back()))
+		str.remove_suffix(1);
+	return str;
+}
+
+// Strips any improperly quoted string & any useless whitespace
+inline constexpr std::string_view trim_quotes(std::string_view str)
+{
+	auto isTrimmed = [](char c) { return is_space(c) || c == '"' || c == '\''; };
+	while (!str.empty() && isTrimmed(str.front()))
+		str.remove_prefix(1);
+	while (!str.empty() && isTrimmed(str.back()))
+		str.remove_suffix(1);
+	return str;
+}
+
+inline constexpr bool iequals(std::string_view a, std::string_view b)
+{
+	if (a.size() != b.size())
+		return false;
+	for (size_t i = 0; i < a.size(); i++)
+		if (to_lower(a[i]) != to_lower(b[i]))
+			return false;
+	return true;
+}
+
+// Accepts the same values inih did: true/yes/on/1 & false/no/off/0
+inline constexpr bool parse_bool(std::string_view str, bool& out)
+{
+	str = trim_quotes(str);
+	if (iequals(str, "true") || iequals(str, "yes") || iequals(str, "on") || str == "1")
+	{
+		out = true;
+		return true;
+	}
+	if (iequals(str, "false") || iequals(str, "no") || iequals(str, "off") || str == "0")
+	{
+		out = false;
+		return true;
+	}
+	return false;
+}
+
+inline bool parse_int(std::string_view str, int& out)
+{
+	str = trim_quotes(str);
+	if (!str.empty() && str.front() == '+')
+		str.remove_prefix(1);
+
+	int value = 0;
+	auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+	if (ec != std::errc{} || ptr == str.data())
+		return false;
+
+	out = value;
+	return true;
+}
+
+// Walks through INI text line by line, calling handler(const Entry&) for each key/value pair
+// Handler can return false to stop parsing early, returns the number of malformed lines that were skipped
+template <typename Handler>
+size_t parse(std::string_view text, Handler&& handler)
+{
+	// Skip UTF-8 BOM
+	if (text.size() >= 3 && uint8_t(text[0]) == 0xEF && uint8_t(text[1]) == 0xBB && uint8_t(text[2]) == 0xBF)
+		text.remove_prefix(3);
+
+	std::string_view section;
+	size_t numErrors = 0;
+	size_t lineNum = 0;
+
+	while (!text.empty())
+	{
+		const size_t lineEnd = text.find('\n');
+		std::string_view line = text.substr(0, lineEnd);
+		text.remove_prefix(lineEnd == std::string_view::npos ? text.size() : lineEnd + 1);
+		lineNum++;
+
+		line = trim(line);
+		if (line.empty() || line.front() == ';' || line.front() == '#')
+			continue;
+
+		if (line.front() == '[')
+		{
+			const size_t sectionEnd = line.find(']');
+			if (sectionEnd == std::string_view::npos)
+			{
+				numErrors++;
+				continue;
+			}
+
+			section = trim(line.substr(1, sectionEnd - 1));
+			continue;
+		}
+
+		const size_t separator = line.find_first_of("=:");
+		if (separator == std::string_view::npos)
+		{
+			numErrors++;
+			continue;
+		}
+
+		// Lines like "=====" are just decoration, nothing to hand over
+		const std::string_view key = trim(line.substr(0, separator));
+		if (key.empty())
+			continue;
+
+		std::string_view value = line.substr(separator + 1);
+
+		// Inline comments need whitespace before them, so values like paths can still contain ';'
+		for (size_t i = 1; i < value.size(); i++)
+		{
+			if (value[i] == ';' && is_space(value[i - 1]))
+			{
+				value = value.substr(0, i);
+				break;
+			}
+		}
+
+		const Entry entry{ section, key, trim(value), lineNum };
+		if (!handler(entry))
+			break;
+	}
+
+	return numErrors;
+}
+
+// Returns the value for a single key (or an empty view if not found), stops parsing as soon as it's found
+inline std::string_view find_value(std::string_view text, std::string_view section, std::string_view key)
+{
+	std::string_view result;
+	parse(text, [&](const Entry& entry) {
+		if (iequals(entry.section, section) && iequals(entry.key, key))
+		{
+			result = entry.value;
+			return false;
+		}
+		return true;
+	});
+	return result;
+}
+};
@@ -0,0 +1,387 @@
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+#include "DLSSTweaks.hpp"
+#include "Log.hpp"
+#include "IniParser.hpp"
+
+IniWatchStats iniWatchStats{};
+
+namespace
+{
+// Editors tend to fire off several change events per save (truncate/write/attrib updates...)
+// so wait until no more events have come in for this long before reloading
+constexpr DWORD DebounceMs = 100;
+
+// If the INI is still locked by whatever is writing to it, retry with a short backoff (10ms, 20ms, 40ms... ~630ms total)
+constexpr DWORD RetryInitialDelayMs = 10;
+constexpr int RetryAttempts = 6;
+
+// Only a handful of our own files live in each folder, but games can write a lot of other files next to them
+// 16KB holds a few hundred events before overflowing, which would otherwise force a reload check
+constexpr size_t ChangeBufferSize = 16 * 1024;
+
+// Single (non-recursive) directory being watched, along with the names of the INIs inside it that we care about
+struct WatchedDir
+{
+	std::filesystem::path path;
+	std::vector<std::wstring> fileNames;
+
+	HANDLE handle = INVALID_HANDLE_VALUE;
+	OVERLAPPED overlapped{};
+	alignas(DWORD) uint8_t buffer[ChangeBufferSize]; // ReadDirectoryChangesW needs DWORD alignment
+
+	~WatchedDir()
+	{
+		if (handle != INVALID_HANDLE_VALUE)
+		{
+			// A pending ReadDirectoryChangesW writes into buffer & overlapped, so the cancelled read has to finish before they're freed
+			if (overlapped.hEvent && CancelIoEx(handle, &overlapped))
+			{
+				DWORD bytesTransferred = 0;
+				GetOverlappedResult(handle, &overlapped, &bytesTransferred, TRUE);
+			}
+			CloseHandle(handle);
+		}
+		if (overlapped.hEvent)
+			CloseHandle(overlapped.hEvent);
+	}
+
+	bool open()
+	{
+		handle = CreateFileW(path.c_str(),
+			FILE_LIST_DIRECTORY,
+			FILE_SHARE_WRITE | FILE_SHARE_READ | FILE_SHARE_DELETE,
+			NULL,
+			OPEN_EXISTING,
+			FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+			NULL);
+
+		if (handle == INVALID_HANDLE_VALUE)
+		{
+			spdlog::warn("INI monitoring: CreateFileW \"{}\" failed with error code {}", path.string(), GetLastError());
+			return false;
+		}
+
+		overlapped.hEvent = CreateEvent(NULL, FALSE, 0, NULL);
+		if (!overlapped.hEvent)
+		{
+			spdlog::error("INI monitoring: CreateEvent failed with error code {}", GetLastError());
+			return false;
+		}
+
+		return queue_read();
+	}
+
+	bool queue_read()
+	{
+		// Subdirectories are left out, so shader caches/saves/logs written beneath the game folder don't wake us up
+		// Only file name & last write changes are needed to spot saves (including temp file + rename saves)
+		const BOOL success = ReadDirectoryChangesW(
+			handle, buffer, sizeof(buffer), FALSE,
+			FILE_NOTIFY_CHANGE_FILE_NAME |
+			FILE_NOTIFY_CHANGE_LAST_WRITE,
+			NULL, &overlapped, NULL);
+
+		if (!success)
+			spdlog::error("INI monitoring: ReadDirectoryChangesW \"{}\" failed with error code {}", path.string(), GetLastError());
+
+		return success;
+	}
+
+	bool is_watched(std::wstring_view name) const
+	{
+		for (const auto& fileName : fileNames)
+			if (name.size() == fileName.size() && !_wcsnicmp(name.data(), fileName.c_str(), name.size()))
+				return true;
+		return false;
+	}
+
+	// Returns number of events for our INIs, or -1 if the buffer overflowed
+	int read_events(size_t bytesTransferred)
+	{
+		// Zero bytes means the change buffer overflowed & events were dropped, have to assume our INIs could be among them
+		if (!bytesTransferred)
+			return -1;
+
+		int numRelevant = 0;
+		auto* evt = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(buffer);
+		for (;;)
+		{
+			// Some editors save by writing to a temp file & renaming it over the original, so check for those too
+			// evt->FileName isn't null-terminated, compare it in-place using the length given
+			const std::wstring_view name(evt->FileName, evt->FileNameLength / sizeof(WCHAR));
+			const bool isSave = evt->Action == FILE_ACTION_MODIFIED || evt->Action == FILE_ACTION_ADDED || evt->Action == FILE_ACTION_RENAMED_NEW_NAME;
+
+			if (isSave && is_watched(name))
+				numRelevant++;
+			else
+				iniWatchStats.ignoredEvents++;
+
+			// Any more events to handle?
+			if (!evt->NextEntryOffset)
+				break;
+			evt = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(reinterpret_cast<const uint8_t*>(evt) + evt->NextEntryOffset);
+		}
+
+		return numRelevant;
+	}
+};
+
+// Every INI the current settings depend on: root INIs & BaseINIs (even if missing, so creating them gets noticed), BaseINI chain & profile database
+std::vector<std::filesystem::path> CollectWatchedFiles(const UserSettings& userSettings, const std::vector<std::filesystem::path>& rootInis)
+{
+	std::vector<std::filesystem::path> files;
+	auto add = [&files](const std::filesystem::path& path) {
+		if (path.empty())
+			return;
+		const auto absolute = std::filesystem::absolute(path).lexically_normal();
+		if (std::find(files.begin(), files.end(), absolute) == files.end())
+			files.push_back(absolute);
+	};
+
+	for (const auto& root : rootInis)
+		add(root);
+	for (const auto& path : userSettings.iniChain)
+		add(path);
+	for (const auto& path : userSettings.missingInis)
+		add(path);
+	add(userSettings.profilesPath);
+
+	return files;
+}
+
+// Stamp & content hash of a watched file, as of when the INIs were last parsed
+struct FileState
+{
+	std::filesystem::path path;
+	utility::FileStamp stamp;
+	uint64_t hash = 0;
+};
+
+uint64_t HashFile(const std::filesystem::path& path)
+{
+	ini::MappedFile iniFile;
+	if (iniFile.open(path))
+		return utility::fnv1a(iniFile.view());
+	return utility::fnv1a(std::string_view("\0missing", 8));
+}
+
+// Runs entirely on the service thread: directory events, debounce & retry timers are all registered with it
+class IniWatcher
+{
+public:
+	IniWatcher(UserSettings& userSettings, const std::vector<std::filesystem::path>& rootInis)
+		: m_settings(userSettings), m_rootInis(rootInis)
+	{
+	}
+
+	bool start()
+	{
+		if (!update_watches())
+			return false;
+
+		// Contents we last parsed, saves that don't actually change anything can then be skipped
+		// (InitThread has already read the INIs by this point, so hash whatever is there now)
+		m_fileStates = file_states();
+
+		spdlog::info("INI monitoring: watching for INI updates ({} files in {} folders)...", m_files.size(), m_dirs.size());
+		return true;
+	}
+
+private:
+	// Opens a watch on each folder holding one of our files, returns false if none could be watched
+	bool update_watches()
+	{
+		m_files = CollectWatchedFiles(*current_settings(), m_rootInis);
+
+		for (auto& dir : m_dirs)
+			dir->fileNames.clear();
+
+		for (const auto& file : m_files)
+		{
+			const auto folder = file.parent_path();
+			auto it = std::find_if(m_dirs.begin(), m_dirs.end(), [&folder](const auto& dir) { return dir->path == folder; });
+			if (it == m_dirs.end())
+			{
+				auto dir = std::make_unique<WatchedDir>();
+				dir->path = folder;
+				if (!dir->open())
+					continue;
+
+				WatchedDir* dirPtr = dir.get();
+				if (!service::add_handle(dir->overlapped.hEvent, [this, dirPtr]() { on_dir_event(*dirPtr); }))
+				{
+					spdlog::warn("INI monitoring: too many handles registered, not watching {}", folder.string());
+					continue;
+				}
+
+				spdlog::debug("INI monitoring: watching {}", folder.string());
+				it = m_dirs.insert(m_dirs.end(), std::move(dir));
+			}
+			(*it)->fileNames.push_back(file.filename().wstring());
+		}
+
+		// Folders that no longer hold any of our INIs (eg. BaseINI was changed) can be dropped
+		remove_dirs([](const WatchedDir& dir) { return dir.fileNames.empty(); });
+
+		return !m_dirs.empty();
+	}
+
+	template <typename Pred> void remove_dirs(Pred pred)
+	{
+		std::erase_if(m_dirs, [&pred](const auto& dir) {
+			if (!pred(*dir))
+				return false;
+
+			// Service thread has to stop waiting on the event before the WatchedDir destructor closes it
+			service::remove_handle(dir->overlapped.hEvent);
+			return true;
+		});
+	}
+
+	void on_dir_event(WatchedDir& dir)
+	{
+		iniWatchStats.wakeups++;
+
+		DWORD bytesTransferred = 0;
+		GetOverlappedResult(dir.handle, &dir.overlapped, &bytesTransferred, FALSE);
+
+		const int numRelevant = dir.read_events(bytesTransferred);
+		if (numRelevant < 0)
+			iniWatchStats.overflows++;
+		else
+			iniWatchStats.relevantEvents += numRelevant;
+
+		if (numRelevant != 0)
+		{
+			// Restart the debounce window, reload only happens once the INIs have been quiet for DebounceMs
+			if (m_debounceTimer)
+				service::cancel_timer(m_debounceTimer);
+
+			// Events arriving while a reload is still being retried belong to the same burst, so latency is measured from its first one
+			if (m_numEvents == 0)
+				m_firstEventTime = std::chrono::steady_clock::now();
+
+			m_debounceTimer = service::add_timer(DebounceMs, [this]() {
+				m_debounceTimer = 0;
+				reload(0);
+			});
+			m_numEvents++;
+		}
+
+		// Queue the next event
+		if (!dir.queue_read())
+			remove_dirs([&dir](const WatchedDir& other) { return &other == &dir; });
+	}
+
+	// Only files whose stamp has changed since the last parse get read & hashed again, the rest keep their previous hash
+	std::vector<FileState> file_states() const
+	{
+		std::vector<FileState> states;
+		states.reserve(m_files.size());
+		for (const auto& file : m_files)
+		{
+			FileState state{ file, utility::GetFileStamp(file) };
+			const auto prev = std::find_if(m_fileStates.begin(), m_fileStates.end(), [&file](const FileState& other) { return other.path == file; });
+			if (prev != m_fileStates.end() && prev->stamp == state.stamp)
+				state.hash = prev->hash;
+			else
+				state.hash = HashFile(file);
+			states.push_back(std::move(state));
+		}
+		return states;
+	}
+
+	bool contents_changed(const std::vector<FileState>& states) const
+	{
+		return !std::equal(states.begin(), states.end(), m_fileStates.begin(), m_fileStates.end(),
+			[](const FileState& a, const FileState& b) { return a.path == b.path && a.hash == b.hash; });
+	}
+
+	void reload(int attempt)
+	{
+		// A new change event has restarted the debounce, that reload will replace any pending retry
+		if (m_retryTimer)
+		{
+			service::cancel_timer(m_retryTimer);
+			m_retryTimer = 0;
+		}
+
+		auto states = file_states();
+		const auto latencyMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_firstEventTime).count();
+
+		if (!contents_changed(states))
+		{
+			m_fileStates = std::move(states); // stamps may still have changed, no need to re-hash for those next time
+			iniWatchStats.redundantReloads++;
+			spdlog::debug("INI monitoring: INIs unchanged after {} change event(s), skipped reload ({} redundant so far)", m_numEvents, iniWatchStats.redundantReloads.load());
+			m_numEvents = 0;
+			return;
+		}
+
+		if (!m_settings.read(m_rootInis))
+		{
+			if (attempt + 1 >= RetryAttempts)
+			{
+				spdlog::error("INI monitoring: failed to read INIs after {} attempts, will retry on next change", RetryAttempts);
+				m_numEvents = 0;
+				return;
+			}
+
+			// Still locked by whatever is writing to it, try again in a bit without blocking the service thread
+			m_retryTimer = service::add_timer(RetryInitialDelayMs << attempt, [this, attempt]() {
+				m_retryTimer = 0;
+				reload(attempt + 1);
+			});
+			return;
+		}
+
+		iniWatchStats.reloads++;
+		spdlog::info("Config updated from {}", m_rootInis.back().string());
+		spdlog::debug("INI monitoring: reload #{} took {:.1f}ms from first change event ({} event(s) coalesced, {} attempt(s))",
+			iniWatchStats.reloads.load(), latencyMs, m_numEvents, attempt + 1);
+		spdlog::debug("INI monitoring: {} wakeups so far, {} ignored events, {} relevant, {} overflows, {} redundant reloads skipped",
+			iniWatchStats.wakeups.load(), iniWatchStats.ignoredEvents.load(), iniWatchStats.relevantEvents.load(),
+			iniWatchStats.overflows.load(), iniWatchStats.redundantReloads.load());
+		m_numEvents = 0;
+
+		// BaseINI might have been added/changed, so the set of files (& folders) to watch could be different now
+		if (CollectWatchedFiles(*current_settings(), m_rootInis) != m_files)
+			update_watches();
+
+		m_fileStates = file_states();
+	}
+
+	UserSettings& m_settings;
+	std::vector<std::filesystem::path> m_rootInis;
+
+	std::vector<std::filesystem::path> m_files;
+	std::vector<std::unique_ptr<WatchedDir>> m_dirs;
+
+	std::vector<FileState> m_fileStates;
+	size_t m_numEvents = 0; // events coalesced into the pending reload, only reset once it has succeeded, been skipped or given up
+	std::chrono::steady_clock::time_point m_firstEventTime{};
+	service::TimerId m_debounceTimer = 0;
+	service::TimerId m_retryTimer = 0;
+};
+
+std::unique_ptr<IniWatcher> iniWatcher;
+};
+
+void UserSettings::watch_for_changes(const std::vector<std::filesystem::path>& rootInis)
+{
+	// Set up on the service thread, so the watcher is only ever touched from there
+	service::post([this, rootInis]() {
+		iniWatcher = std::make_unique<IniWatcher>(*this, rootInis);
+		if (!iniWatcher->start())
+		{
+			spdlog::error("INI monitoring: couldn't watch any INI folders, INI changes won't be applied until restart");
+			iniWatcher.reset();
+		}
+	});
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+// Everything logs through the spdlog API, DLSSTWEAKS_MINIMAL_LOG builds swap spdlog itself out for MiniLog
+#ifdef DLSSTWEAKS_MINIMAL_LOG
+#include "MiniLog.hpp"
+#else
+#include <spdlog/spdlog.h>
+#endif
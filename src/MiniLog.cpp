@@ -0,0 +1,355 @@
+#ifdef DLSSTWEAKS_MINIMAL_LOG
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <time.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstdio>
+#include <mutex>
+
+#include "MiniLog.hpp"
+
+namespace minilog
+{
+namespace
+{
+// Anything past this gets cut off, keeps logging free of allocations once the file is open
+constexpr size_t MaxLineLength = 2048;
+
+constexpr std::string_view LevelNames[] = { "trace", "debug", "info", "warning", "error", "critical", "off" };
+
+// Either appends to a string, or fills a fixed buffer & silently drops whatever doesn't fit
+class Output
+{
+public:
+	explicit Output(std::string& str) : m_string(&str) {}
+	Output(char* buffer, size_t capacity) : m_buffer(buffer), m_capacity(capacity) {}
+
+	void put(std::string_view text)
+	{
+		if (m_string)
+		{
+			m_string->append(text);
+			return;
+		}
+		const size_t count = std::min(text.size(), m_capacity - m_size);
+		std::copy_n(text.data(), count, m_buffer + m_size);
+		m_size += count;
+	}
+
+	void put(char c, size_t count)
+	{
+		if (m_string)
+		{
+			m_string->append(count, c);
+			return;
+		}
+		count = std::min(count, m_capacity - m_size);
+		std::fill_n(m_buffer + m_size, count, c);
+		m_size += count;
+	}
+
+	size_t size() const { return m_size; }
+
+private:
+	std::string* m_string = nullptr;
+	char* m_buffer = nullptr;
+	size_t m_capacity = 0;
+	size_t m_size = 0;
+};
+
+struct Spec
+{
+	char align = 0; // '<', '>' or '^', 0 uses the default for the type
+	size_t width = 0;
+	int precision = -1;
+	char type = 0;
+};
+
+size_t parse_number(std::string_view text, size_t& pos)
+{
+	size_t value = 0;
+	while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9')
+		value = value * 10 + size_t(text[pos++] - '0');
+	return value;
+}
+
+Spec parse_spec(std::string_view text)
+{
+	Spec spec;
+	size_t pos = 0;
+	if (pos < text.size() && (text[pos] == '<' || text[pos] == '>' || text[pos] == '^'))
+		spec.align = text[pos++];
+	spec.width = parse_number(text, pos);
+	if (pos < text.size() && text[pos] == '.')
+	{
+		pos++;
+		spec.precision = int(parse_number(text, pos));
+	}
+	if (pos < text.size())
+		spec.type = text[pos];
+	return spec;
+}
+
+void format_arg(Output& out, const Arg& arg, const Spec& spec)
+{
+	char buffer[64];
+	char* end = buffer;
+	std::string_view text;
+	bool numeric = true;
+
+	const bool hex = spec.type == 'x' || spec.type == 'X';
+	switch (arg.type)
+	{
+	case ArgType::Bool:
+		text = arg.i ? "true" : "false";
+		numeric = false;
+		break;
+	case ArgType::Char:
+		buffer[0] = char(arg.i);
+		text = std::string_view(buffer, 1);
+		numeric = false;
+		break;
+	case ArgType::Int:
+		end = std::to_chars(buffer, std::end(buffer), arg.i, hex ? 16 : 10).ptr;
+		break;
+	case ArgType::UInt:
+		end = std::to_chars(buffer, std::end(buffer), arg.u, hex ? 16 : 10).ptr;
+		break;
+	case ArgType::Float:
+	case ArgType::Double:
+		// Same as fmt, shortest representation unless a precision was given
+		if (spec.precision >= 0)
+			end = std::to_chars(buffer, std::end(buffer), arg.d, std::chars_format::fixed, spec.precision).ptr;
+		else if (arg.type == ArgType::Float)
+			end = std::to_chars(buffer, std::end(buffer), float(arg.d)).ptr;
+		else
+			end = std::to_chars(buffer, std::end(buffer), arg.d).ptr;
+		break;
+	case ArgType::String:
+		text = arg.s;
+		numeric = false;
+		break;
+	case ArgType::Pointer:
+		buffer[0] = '0';
+		buffer[1] = 'x';
+		end = std::to_chars(buffer + 2, std::end(buffer), uintptr_t(arg.p), 16).ptr;
+		break;
+	}
+
+	if (numeric)
+	{
+		if (spec.type == 'X')
+			std::transform(buffer, end, buffer, [](char c) { return c >= 'a' && c <= 'f' ? char(c - 'a' + 'A') : c; });
+		text = std::string_view(buffer, size_t(end - buffer));
+	}
+
+	const size_t padding = spec.width > text.size() ? spec.width - text.size() : 0;
+	const char align = spec.align ? spec.align : (numeric ? '>' : '<');
+	const size_t before = align == '>' ? padding : align == '^' ? padding / 2 : 0;
+
+	out.put(' ', before);
+	out.put(text);
+	out.put(' ', padding - before);
+}
+
+void format(Output& out, std::string_view fmt, const Arg* args, size_t numArgs)
+{
+	size_t nextArg = 0;
+	size_t pos = 0;
+	while (pos < fmt.size())
+	{
+		const size_t brace = fmt.find_first_of("{}", pos);
+		if (brace == std::string_view::npos)
+		{
+			out.put(fmt.substr(pos));
+			break;
+		}
+
+		out.put(fmt.substr(pos, brace - pos));
+
+		// Escaped {{ & }}
+		if (brace + 1 < fmt.size() && fmt[brace + 1] == fmt[brace])
+		{
+			out.put(fmt.substr(brace, 1));
+			pos = brace + 2;
+			continue;
+		}
+
+		const size_t close = fmt[brace] == '{' ? fmt.find('}', brace) : std::string_view::npos;
+		if (close == std::string_view::npos)
+		{
+			out.put(fmt.substr(brace));
+			break;
+		}
+
+		std::string_view field = fmt.substr(brace + 1, close - brace - 1);
+		std::string_view specText;
+		if (const size_t colon = field.find(':'); colon != std::string_view::npos)
+		{
+			specText = field.substr(colon + 1);
+			field = field.substr(0, colon);
+		}
+
+		size_t index = nextArg++;
+		if (!field.empty())
+		{
+			size_t fieldPos = 0;
+			index = parse_number(field, fieldPos);
+		}
+
+		if (index < numArgs)
+			format_arg(out, args[index], parse_spec(specText));
+
+		pos = close + 1;
+	}
+}
+
+std::atomic<int> currentLevel = spdlog::level::info;
+
+std::mutex fileMutex;
+FILE* file = nullptr;
+bool fileOpened = false;
+std::string pending;
+
+void write_line(std::string_view line)
+{
+#ifdef _WIN32
+	// Matches spdlog's msvc_sink, only bothers formatting for OutputDebugString if something's listening
+	if (IsDebuggerPresent())
+		OutputDebugStringA(line.data());
+#endif
+
+	std::lock_guard lock(fileMutex);
+	if (!fileOpened)
+		pending.append(line);
+	else if (file)
+	{
+		fwrite(line.data(), 1, line.size(), file);
+		fflush(file);
+	}
+}
+
+void put_timestamp(Output& out)
+{
+	int year, month, day, hour, minute, second, millisecond;
+#ifdef _WIN32
+	SYSTEMTIME time;
+	GetLocalTime(&time);
+	year = time.wYear;
+	month = time.wMonth;
+	day = time.wDay;
+	hour = time.wHour;
+	minute = time.wMinute;
+	second = time.wSecond;
+	millisecond = time.wMilliseconds;
+#else
+	timespec now;
+	clock_gettime(CLOCK_REALTIME, &now);
+	tm local;
+	localtime_r(&now.tv_sec, &local);
+	year = local.tm_year + 1900;
+	month = local.tm_mon + 1;
+	day = local.tm_mday;
+	hour = local.tm_hour;
+	minute = local.tm_min;
+	second = local.tm_sec;
+	millisecond = int(now.tv_nsec / 1000000);
+#endif
+
+	// Same layout as spdlog's default pattern: [2023-01-02 03:04:05.678]
+	char buffer[32];
+	char* p = buffer;
+	const auto put_digits = [&p](int value, int digits) {
+		for (int i = digits - 1; i >= 0; i--, value /= 10)
+			p[i] = char('0' + value % 10);
+		p += digits;
+	};
+	*p++ = '[';
+	put_digits(year, 4);
+	*p++ = '-';
+	put_digits(month, 2);
+	*p++ = '-';
+	put_digits(day, 2);
+	*p++ = ' ';
+	put_digits(hour, 2);
+	*p++ = ':';
+	put_digits(minute, 2);
+	*p++ = ':';
+	put_digits(second, 2);
+	*p++ = '.';
+	put_digits(millisecond, 3);
+	*p++ = ']';
+	out.put(std::string_view(buffer, size_t(p - buffer)));
+}
+};
+
+void format_to(std::string& out, std::string_view fmt, const Arg* args, size_t numArgs)
+{
+	Output output(out);
+	format(output, fmt, args, numArgs);
+}
+
+bool should_log(spdlog::level::level_enum level)
+{
+	return level >= currentLevel.load(std::memory_order_relaxed);
+}
+
+void set_level(spdlog::level::level_enum level)
+{
+	currentLevel.store(level, std::memory_order_relaxed);
+}
+
+void write(spdlog::level::level_enum level, std::string_view fmt, const Arg* args, size_t numArgs)
+{
+	// Room for the newline & null terminator
+	char line[MaxLineLength + 2];
+	Output out(line, MaxLineLength);
+
+	put_timestamp(out);
+	out.put(" [");
+	out.put(LevelNames[std::clamp<int>(level, spdlog::level::trace, spdlog::level::off)]);
+	out.put("] ");
+	format(out, fmt, args, numArgs);
+
+	size_t length = out.size();
+	line[length++] = '\n';
+	line[length] = '\0';
+	write_line(std::string_view(line, length));
+}
+
+bool open_file(const std::filesystem::path& path)
+{
+#ifdef _WIN32
+	FILE* opened = _wfopen(path.c_str(), L"wb");
+#else
+	FILE* opened = fopen(path.c_str(), "wb");
+#endif
+
+	std::lock_guard lock(fileMutex);
+	if (fileOpened)
+	{
+		if (opened)
+			fclose(opened);
+		return file != nullptr;
+	}
+
+	file = opened;
+	fileOpened = true;
+
+	if (file)
+	{
+		fwrite(pending.data(), 1, pending.size(), file);
+		fflush(file);
+	}
+	pending.clear();
+	pending.shrink_to_fit();
+	return file != nullptr;
+}
+};
+#endif
@@ -0,0 +1,175 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Small stand-in for spdlog, used by DLSSTWEAKS_MINIMAL_LOG builds so that spdlog/fmt/iostreams aren't mapped into the game process
+// Only implements the parts of the spdlog & fmt APIs that DLSSTweaks uses, format strings support {} with optional alignment/width, precision & x/X/f types
+// Kept free of any Win32/NGX dependencies so it can also be built on other platforms
+namespace spdlog
+{
+namespace level
+{
+enum level_enum : int
+{
+	trace,
+	debug,
+	info,
+	warn,
+	err,
+	critical,
+	off,
+};
+};
+};
+
+namespace minilog
+{
+enum class ArgType : uint8_t
+{
+	Bool,
+	Char,
+	Int,
+	UInt,
+	Float,
+	Double,
+	String,
+	Pointer,
+};
+
+// Type-erased format argument, strings are only referenced so an Arg must not outlive what it was made from
+struct Arg
+{
+	ArgType type = ArgType::Int;
+	union
+	{
+		int64_t i = 0;
+		uint64_t u;
+		double d;
+		const void* p;
+	};
+	std::string_view s;
+};
+
+template <typename T>
+Arg make_arg(const T& value)
+{
+	Arg arg;
+	if constexpr (std::is_same_v<T, bool>)
+	{
+		arg.type = ArgType::Bool;
+		arg.i = value;
+	}
+	else if constexpr (std::is_same_v<T, char>)
+	{
+		arg.type = ArgType::Char;
+		arg.i = value;
+	}
+	else if constexpr (std::is_enum_v<T>)
+		return make_arg(std::underlying_type_t<T>(value));
+	else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+	{
+		arg.type = ArgType::Int;
+		arg.i = int64_t(value);
+	}
+	else if constexpr (std::is_integral_v<T>)
+	{
+		arg.type = ArgType::UInt;
+		arg.u = uint64_t(value);
+	}
+	else if constexpr (std::is_floating_point_v<T>)
+	{
+		arg.type = std::is_same_v<T, float> ? ArgType::Float : ArgType::Double;
+		arg.d = double(value);
+	}
+	else if constexpr (std::is_same_v<T, const char*> || std::is_same_v<T, char*>)
+	{
+		arg.type = ArgType::String;
+		arg.s = value ? std::string_view(value) : std::string_view("(null)");
+	}
+	else if constexpr (std::is_convertible_v<const T&, std::string_view>)
+	{
+		arg.type = ArgType::String;
+		arg.s = std::string_view(value);
+	}
+	else if constexpr (std::is_pointer_v<T>)
+	{
+		arg.type = ArgType::Pointer;
+		arg.p = (const void*)value;
+	}
+	else
+		static_assert(sizeof(T) == 0, "minilog: unsupported format argument type");
+	return arg;
+}
+
+// Appends formatted text to `out`
+void format_to(std::string& out, std::string_view fmt, const Arg* args, size_t numArgs);
+
+bool should_log(spdlog::level::level_enum level);
+void set_level(spdlog::level::level_enum level);
+
+// Lines longer than the fixed line buffer are truncated
+void write(spdlog::level::level_enum level, std::string_view fmt, const Arg* args, size_t numArgs);
+
+// Anything logged before this is held in memory & written out once the file is opened
+// If the file can't be opened logging carries on without it (debugger output is still written)
+bool open_file(const std::filesystem::path& path);
+};
+
+namespace spdlog
+{
+inline void set_level(level::level_enum level)
+{
+	minilog::set_level(level);
+}
+
+template <typename... Args>
+void log(level::level_enum level, std::string_view fmt, const Args&... args)
+{
+	if (!minilog::should_log(level))
+		return;
+
+	// Extra entry so there's never a zero-sized array
+	const minilog::Arg packed[] = { minilog::make_arg(args)..., minilog::Arg{} };
+	minilog::write(level, fmt, packed, sizeof...(Args));
+}
+
+template <typename... Args>
+void debug(std::string_view fmt, const Args&... args)
+{
+	log(level::debug, fmt, args...);
+}
+
+template <typename... Args>
+void info(std::string_view fmt, const Args&... args)
+{
+	log(level::info, fmt, args...);
+}
+
+template <typename... Args>
+void warn(std::string_view fmt, const Args&... args)
+{
+	log(level::warn, fmt, args...);
+}
+
+template <typename... Args>
+void error(std::string_view fmt, const Args&... args)
+{
+	log(level::err, fmt, args...);
+}
+};
+
+namespace fmt
+{
+template <typename... Args>
+std::string format(std::string_view fmt, const Args&... args)
+{
+	const minilog::Arg packed[] = { minilog::make_arg(args)..., minilog::Arg{} };
+	std::string result;
+	minilog::format_to(result, fmt, packed, sizeof...(Args));
+	return result;
+}
+};
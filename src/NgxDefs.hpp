@@ -0,0 +1,80 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <string_view>
+#include <utility>
+#include <nvsdk_ngx_defs.h>
+
+// NGX-side definitions shared between the hooks & the decision logic in HookLogic
+// Kept free of any Win32 dependencies so it can also be built on other platforms
+
+// Certain settings which aren't currently included in DLSS SDK, but do seem checked by DLSS 3.1+ DLL files.
+#ifndef NVSDK_NGX_Parameter_Disable_Watermark
+#define NVSDK_NGX_Parameter_Disable_Watermark "Disable.Watermark"
+#endif
+#ifndef NVSDK_NGX_Parameter_DLSS_Get_Dynamic
+#define NVSDK_NGX_Parameter_DLSS_Get_Dynamic "DLSS.Get.Dynamic."
+#endif
+
+constexpr float DLSS_MinScale = 0.0f;
+constexpr float DLSS_MaxScale = 1.0f;
+
+struct QualityLevel
+{
+	std::string_view name; // always one of QualityLevelNames
+	float scalingRatio = 0.f;
+	std::pair<int, int> resolution = { 0,0 };
+
+	unsigned int preset = NVSDK_NGX_DLSS_Hint_Render_Preset_Default;
+};
+
+constexpr size_t NumQualityLevels = size_t(NVSDK_NGX_PerfQuality_Value_DLAA) + 1;
+
+// Indexed by NVSDK_NGX_PerfQuality_Value
+constexpr std::array<std::string_view, NumQualityLevels> QualityLevelNames =
+{
+	"Performance", // MaxPerf
+	"Balanced",
+	"Quality", // MaxQuality
+	"UltraPerformance",
+	"UltraQuality",
+	"DLAA",
+};
+
+// The last resolution we told game about for each level, so we can check against it later on
+// (based on either `scalingRatio` or `resolution` set by the user), indexed by NVSDK_NGX_PerfQuality_Value
+using ReportedResolutions = std::array<std::pair<int, int>, NumQualityLevels>;
+
+// Fixed-size table of every quality level, indexed directly by the NGX enum value
+// Used in place of a map so the hooks don't need any hashing/allocations, and so iteration always happens in enum order
+class QualityTable
+{
+public:
+	using value_type = std::pair<NVSDK_NGX_PerfQuality_Value, QualityLevel>;
+
+	constexpr QualityTable()
+	{
+		for (size_t i = 0; i < NumQualityLevels; i++)
+			m_levels[i] = { NVSDK_NGX_PerfQuality_Value(i), QualityLevel{ QualityLevelNames[i] } };
+	}
+
+	// Levels passed in by the game should be checked with this first, they aren't guaranteed to be in range
+	bool contains(NVSDK_NGX_PerfQuality_Value level) const { return size_t(level) < NumQualityLevels; }
+
+	constexpr QualityLevel& operator[](NVSDK_NGX_PerfQuality_Value level) { return m_levels[size_t(level)].second; }
+	constexpr const QualityLevel& operator[](NVSDK_NGX_PerfQuality_Value level) const { return m_levels[size_t(level)].second; }
+
+	QualityLevel& at(NVSDK_NGX_PerfQuality_Value level) { return m_levels.at(size_t(level)).second; }
+	const QualityLevel& at(NVSDK_NGX_PerfQuality_Value level) const { return m_levels.at(size_t(level)).second; }
+
+	auto begin() { return m_levels.begin(); }
+	auto end() { return m_levels.end(); }
+	auto begin() const { return m_levels.begin(); }
+	auto end() const { return m_levels.end(); }
+
+private:
+	std::array<value_type, NumQualityLevels> m_levels{};
+};
+
+// Built entirely at compile time, so tables held in globals don't add any static-init work
+static_assert(QualityTable{}[NVSDK_NGX_PerfQuality_Value_DLAA].name == "DLAA");
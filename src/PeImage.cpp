@@ -0,0 +1,407 @@
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "PeImage.hpp"
+
+namespace pe
+{
+namespace
+{
+constexpr uint16_t DosSignature = 0x5A4D; // MZ
+constexpr uint32_t NtSignature = 0x00004550; // PE\0\0
+constexpr uint16_t OptionalHeader32Magic = 0x10B;
+constexpr uint16_t OptionalHeader64Magic = 0x20B;
+
+constexpr uint32_t DirectoryExport = 0;
+constexpr uint32_t DirectoryImport = 1;
+
+constexpr size_t FileHeaderSize = 20;
+constexpr size_t SectionHeaderSize = 40;
+constexpr size_t ExportDirectorySize = 40;
+constexpr size_t ImportDescriptorSize = 20;
+
+// Headers aren't guaranteed to be aligned in file data, so everything is read through memcpy
+template <typename T>
+T read(const uint8_t* ptr)
+{
+	T value;
+	std::memcpy(&value, ptr, sizeof(T));
+	return value;
+}
+
+constexpr char to_lower(char c)
+{
+	return (c >= 'A' && c <= 'Z') ? char(c - 'A' + 'a') : c;
+}
+
+constexpr bool iequals(std::string_view a, std::string_view b)
+{
+	if (a.size() != b.size())
+		return false;
+	for (size_t i = 0; i < a.size(); i++)
+		if (to_lower(a[i]) != to_lower(b[i]))
+			return false;
+	return true;
+}
+
+// 32-bit FNV-1a, module names are hashed case-folded since Windows treats them case-insensitively
+constexpr uint32_t hash_name(std::string_view name, bool fold)
+{
+	uint32_t hash = 0x811c9dc5u;
+	for (const char c : name)
+	{
+		hash ^= uint8_t(fold ? to_lower(c) : c);
+		hash *= 0x01000193u;
+	}
+	return hash;
+}
+};
+
+bool Image::parse_mapped(const void* base)
+{
+	return parse(static_cast<const uint8_t*>(base), std::numeric_limits<size_t>::max(), true);
+}
+
+bool Image::parse_file(const void* data, size_t size)
+{
+	return parse(static_cast<const uint8_t*>(data), size, false);
+}
+
+bool Image::parse(const uint8_t* base, size_t size, bool mapped)
+{
+	*this = Image{};
+	if (!base || size < 0x40 || read<uint16_t>(base) != DosSignature)
+		return false;
+
+	const uint32_t ntOffset = read<uint32_t>(base + 0x3C);
+	if (uint64_t(ntOffset) + 4 + FileHeaderSize > size || read<uint32_t>(base + ntOffset) != NtSignature)
+		return false;
+
+	const uint8_t* fileHeader = base + ntOffset + 4;
+	const uint16_t numSections = read<uint16_t>(fileHeader + 2);
+	const uint16_t optionalHeaderSize = read<uint16_t>(fileHeader + 16);
+
+	const uint8_t* optionalHeader = fileHeader + FileHeaderSize;
+	const uint64_t optionalHeaderOffset = uint64_t(ntOffset) + 4 + FileHeaderSize;
+	if (optionalHeaderOffset + optionalHeaderSize + uint64_t(numSections) * SectionHeaderSize > size || optionalHeaderSize < 2)
+		return false;
+
+	const uint16_t magic = read<uint16_t>(optionalHeader);
+	if (magic != OptionalHeader32Magic && magic != OptionalHeader64Magic)
+		return false;
+
+	// Data directories are the only part of the optional header that moves between PE32 & PE32+
+	const bool is64 = magic == OptionalHeader64Magic;
+	const size_t numDirsOffset = is64 ? 108 : 92;
+	if (optionalHeaderSize < numDirsOffset + 4)
+		return false;
+
+	const uint32_t numDirs = read<uint32_t>(optionalHeader + numDirsOffset);
+	auto directory = [&](uint32_t index, uint32_t& rva, uint32_t& dirSize) {
+		rva = dirSize = 0;
+		const size_t offset = numDirsOffset + 4 + index * 8;
+		if (index >= numDirs || offset + 8 > optionalHeaderSize)
+			return;
+		rva = read<uint32_t>(optionalHeader + offset);
+		dirSize = read<uint32_t>(optionalHeader + offset + 4);
+	};
+
+	m_base = base;
+	m_mapped = mapped;
+	m_is64 = is64;
+	m_headersSize = read<uint32_t>(optionalHeader + 60);
+	m_sections = optionalHeader + optionalHeaderSize;
+	m_numSections = numSections;
+
+	// Loader maps the whole image as one block, SizeOfImage is the bound for everything in it
+	m_size = mapped ? read<uint32_t>(optionalHeader + 56) : size;
+
+	uint32_t exportRva, exportSize, importRva, importSize;
+	directory(DirectoryExport, exportRva, exportSize);
+	directory(DirectoryImport, importRva, importSize);
+
+	if (exportRva)
+		index_exports(exportRva, exportSize);
+	if (importRva)
+		index_imports(importRva);
+
+	return true;
+}
+
+const uint8_t* Image::translate(uint32_t rva, size_t& available) const
+{
+	available = 0;
+	if (!m_base)
+		return nullptr;
+
+	if (m_mapped)
+	{
+		if (rva >= m_size)
+			return nullptr;
+		available = m_size - rva;
+		return m_base + rva;
+	}
+
+	for (uint16_t i = 0; i < m_numSections; i++)
+	{
+		const uint8_t* section = m_sections + i * SectionHeaderSize;
+		const uint32_t virtualAddress = read<uint32_t>(section + 12);
+		const uint32_t rawSize = read<uint32_t>(section + 16);
+		const uint32_t rawOffset = read<uint32_t>(section + 20);
+
+		// Anything past the raw data is zero-fill that only exists once mapped, treat it as out of bounds
+		if (rva < virtualAddress || rva - virtualAddress >= rawSize)
+			continue;
+
+		const uint64_t offset = uint64_t(rawOffset) + (rva - virtualAddress);
+		if (offset >= m_size)
+			return nullptr;
+
+		available = size_t(std::min<uint64_t>(rawSize - (rva - virtualAddress), m_size - offset));
+		return m_base + offset;
+	}
+
+	// Headers sit at the same offset in the file as in memory
+	if (rva < m_headersSize && rva < m_size)
+	{
+		available = std::min<size_t>(m_headersSize, m_size) - rva;
+		return m_base + rva;
+	}
+
+	return nullptr;
+}
+
+const uint8_t* Image::rva_to_ptr(uint32_t rva, size_t size) const
+{
+	size_t available = 0;
+	const uint8_t* ptr = translate(rva, available);
+	return ptr && available >= size ? ptr : nullptr;
+}
+
+std::string_view Image::string_at(uint32_t rva) const
+{
+	size_t available = 0;
+	const auto* str = reinterpret_cast<const char*>(translate(rva, available));
+	if (!str)
+		return {};
+
+	// Unterminated strings (truncated/corrupt file) are treated as empty rather than read past the end
+	const void* end = std::memchr(str, 0, available);
+	if (!end)
+		return {};
+	return { str, size_t(static_cast<const char*>(end) - str) };
+}
+
+uint64_t Image::read_thunk(uint32_t rva) const
+{
+	const uint8_t* thunk = rva_to_ptr(rva, m_is64 ? 8 : 4);
+	if (!thunk)
+		return 0;
+	return m_is64 ? read<uint64_t>(thunk) : read<uint32_t>(thunk);
+}
+
+void Image::index_exports(uint32_t dirRva, uint32_t dirSize)
+{
+	const uint8_t* dir = rva_to_ptr(dirRva, ExportDirectorySize);
+	if (!dir)
+		return;
+
+	const uint32_t numFunctions = read<uint32_t>(dir + 20);
+	const uint32_t numNames = read<uint32_t>(dir + 24);
+	const uint32_t functionsRva = read<uint32_t>(dir + 28);
+	const uint32_t namesRva = read<uint32_t>(dir + 32);
+	const uint32_t nameOrdinalsRva = read<uint32_t>(dir + 36);
+
+	if (!rva_to_ptr(functionsRva, size_t(numFunctions) * 4) || !rva_to_ptr(namesRva, size_t(numNames) * 4) ||
+		!rva_to_ptr(nameOrdinalsRva, size_t(numNames) * 2))
+		return;
+
+	m_exportDirRva = dirRva;
+	m_exportDirSize = dirSize;
+	m_functionsRva = functionsRva;
+	m_numFunctions = numFunctions;
+	m_namesRva = namesRva;
+	m_nameOrdinalsRva = nameOrdinalsRva;
+	m_numNames = numNames;
+
+	// Keep the table at most half full so probe chains stay short
+	m_exportsHashed = numNames <= ExportHashSize / 2;
+	if (!m_exportsHashed)
+		return;
+
+	const uint8_t* names = rva_to_ptr(namesRva, size_t(numNames) * 4);
+	for (uint32_t i = 0; i < numNames; i++)
+	{
+		size_t slot = hash_name(string_at(read<uint32_t>(names + i * 4)), false) & (ExportHashSize - 1);
+		while (m_exportHash[slot])
+			slot = (slot + 1) & (ExportHashSize - 1);
+		m_exportHash[slot] = uint16_t(i + 1);
+	}
+}
+
+void Image::index_imports(uint32_t dirRva)
+{
+	m_importDirRva = dirRva;
+	m_importsHashed = true;
+
+	for (uint32_t rva = dirRva;; rva += ImportDescriptorSize)
+	{
+		const uint8_t* descriptor = rva_to_ptr(rva, ImportDescriptorSize);
+		if (!descriptor)
+			break;
+
+		const uint32_t nameRva = read<uint32_t>(descriptor + 12);
+		const uint32_t iatRva = read<uint32_t>(descriptor + 16);
+		if (!nameRva && !iatRva)
+			break; // null descriptor terminates the table
+
+		const ImportModule module{ string_at(nameRva), read<uint32_t>(descriptor), iatRva };
+		if (m_numImports >= MaxHashedImports)
+			m_importsHashed = false;
+		else
+		{
+			size_t slot = hash_name(module.name, true) & (ImportHashSize - 1);
+			while (m_importHash[slot])
+				slot = (slot + 1) & (ImportHashSize - 1);
+			m_imports[m_numImports] = module;
+			m_importHash[slot] = uint8_t(m_numImports + 1);
+		}
+		m_numImports++;
+	}
+}
+
+std::string_view Image::export_name(size_t index) const
+{
+	if (index >= m_numNames)
+		return {};
+	return string_at(read<uint32_t>(rva_to_ptr(m_namesRva) + index * 4));
+}
+
+Image::Export Image::export_at(size_t index) const
+{
+	if (index >= m_numNames)
+		return {};
+
+	const uint16_t ordinal = read<uint16_t>(rva_to_ptr(m_nameOrdinalsRva) + index * 2);
+	if (ordinal >= m_numFunctions)
+		return {};
+
+	Export result;
+	result.rva = read<uint32_t>(rva_to_ptr(m_functionsRva) + size_t(ordinal) * 4);
+	result.forwarded = result.rva >= m_exportDirRva && result.rva < m_exportDirRva + m_exportDirSize;
+	return result;
+}
+
+Image::Export Image::find_export(std::string_view name) const
+{
+	if (!m_numNames)
+		return {};
+
+	if (m_exportsHashed)
+	{
+		for (size_t slot = hash_name(name, false) & (ExportHashSize - 1); m_exportHash[slot]; slot = (slot + 1) & (ExportHashSize - 1))
+		{
+			const size_t index = m_exportHash[slot] - 1;
+			if (export_name(index) == name)
+				return export_at(index);
+		}
+		return {};
+	}
+
+	// string_view compares bytes as unsigned, same order the linker sorts the name table in
+	size_t low = 0;
+	size_t high = m_numNames;
+	while (low < high)
+	{
+		const size_t mid = low + (high - low) / 2;
+		const int cmp = export_name(mid).compare(name);
+		if (cmp == 0)
+			return export_at(mid);
+		if (cmp < 0)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	return {};
+}
+
+template <typename Fn>
+void Image::for_each_import_module(std::string_view module, Fn&& fn) const
+{
+	if (m_importsHashed)
+	{
+		// Same module can be imported by more than one descriptor, so keep going through the whole probe chain
+		for (size_t slot = hash_name(module, true) & (ImportHashSize - 1); m_importHash[slot]; slot = (slot + 1) & (ImportHashSize - 1))
+		{
+			const ImportModule& entry = m_imports[m_importHash[slot] - 1];
+			if (iequals(entry.name, module) && fn(entry))
+				return;
+		}
+		return;
+	}
+
+	for (size_t i = 0; i < m_numImports; i++)
+	{
+		const uint8_t* descriptor = rva_to_ptr(uint32_t(m_importDirRva + i * ImportDescriptorSize), ImportDescriptorSize);
+		const ImportModule entry{ string_at(read<uint32_t>(descriptor + 12)), read<uint32_t>(descriptor), read<uint32_t>(descriptor + 16) };
+		if (iequals(entry.name, module) && fn(entry))
+			return;
+	}
+}
+
+uint32_t Image::find_import(std::string_view module, std::string_view function) const
+{
+	const uint32_t thunkSize = m_is64 ? 8 : 4;
+	const uint64_t ordinalFlag = uint64_t(1) << (thunkSize * 8 - 1);
+
+	uint32_t result = 0;
+	for_each_import_module(module, [&](const ImportModule& entry) {
+		// Once loaded the IAT holds addresses instead of names, so names have to come from the lookup table
+		// Files have the same contents in both, so fall back to the IAT when there's no lookup table
+		const uint32_t namesRva = entry.lookupRva ? entry.lookupRva : (m_mapped ? 0 : entry.iatRva);
+		if (!namesRva)
+			return false;
+
+		for (uint32_t i = 0;; i++)
+		{
+			const uint64_t thunk = read_thunk(namesRva + i * thunkSize);
+			if (!thunk)
+				break;
+			if (thunk & ordinalFlag)
+				continue;
+
+			// IMAGE_IMPORT_BY_NAME: 2-byte hint followed by the name
+			if (string_at(uint32_t(thunk) + 2) == function)
+			{
+				result = entry.iatRva + i * thunkSize;
+				return true;
+			}
+		}
+		return false;
+	});
+	return result;
+}
+
+uint32_t Image::find_import_by_value(std::string_view module, uint64_t value) const
+{
+	const uint32_t thunkSize = m_is64 ? 8 : 4;
+
+	uint32_t result = 0;
+	for_each_import_module(module, [&](const ImportModule& entry) {
+		for (uint32_t i = 0;; i++)
+		{
+			const uint64_t thunk = read_thunk(entry.iatRva + i * thunkSize);
+			if (!thunk)
+				break;
+			if (thunk == value)
+			{
+				result = entry.iatRva + i * thunkSize;
+				return true;
+			}
+		}
+		return false;
+	});
+	return result;
+}
+};
@@ -0,0 +1,130 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Small read-only PE parser, for looking up exports & imports of a module without a GetProcAddress/import descriptor walk per lookup
+// Exports & imports are both indexed in a single pass into fixed-size hash tables held inside the Image, so parsing never allocates
+// Works on modules mapped by the loader as well as raw file contents (kept free of any Win32 dependencies so it can also be built on other platforms)
+namespace pe
+{
+class Image
+{
+public:
+	// Export tables with more names than fit are still usable, lookups on those fall back to binary searching the (sorted) name table
+	static constexpr size_t ExportHashSize = 4096;
+	static constexpr size_t ImportHashSize = 128;
+	static constexpr size_t MaxHashedImports = ImportHashSize / 2;
+
+	struct Export
+	{
+		uint32_t rva = 0;
+		bool forwarded = false; // rva points to a "module.function" forwarder string instead of code
+
+		explicit operator bool() const { return rva != 0; }
+	};
+
+	// Image mapped by the loader (eg. an HMODULE), RVAs are used as offsets directly
+	bool parse_mapped(const void* base);
+
+	// Raw file contents, RVAs are translated through the section table & bounds checked against size
+	bool parse_file(const void* data, size_t size);
+
+	bool valid() const { return m_base != nullptr; }
+	bool is_64bit() const { return m_is64; }
+	size_t num_exports() const { return m_numNames; }
+	size_t num_imports() const { return m_numImports; }
+
+	Export find_export(std::string_view name) const;
+
+	// Walks a list of count names alongside the export name table in a single pass, calling fn(index, export) for each one that's exported
+	// name_at(index) has to return the names sorted byte-wise, same order the PE format requires the name table to be in
+	template <typename NameAt, typename Fn> void join_exports(size_t count, NameAt&& name_at, Fn&& fn) const;
+
+	// Named exports in name table order, which the PE format requires to be sorted
+	std::string_view export_name(size_t index) const;
+	Export export_at(size_t index) const;
+
+	// RVA of the import address table entry for module!function (module name is case-insensitive), 0 if it isn't imported by name
+	uint32_t find_import(std::string_view module, std::string_view function) const;
+
+	// RVA of the import address table entry importing from module that currently holds value
+	// Only meaningful on a mapped image, since the loader fills in the IAT with resolved addresses
+	uint32_t find_import_by_value(std::string_view module, uint64_t value) const;
+
+	// Pointer to size bytes at rva, nullptr if it falls outside the image
+	const uint8_t* rva_to_ptr(uint32_t rva, size_t size = 1) const;
+
+private:
+	struct ImportModule
+	{
+		std::string_view name;
+		uint32_t lookupRva; // OriginalFirstThunk, import names (can be 0 in old linker output)
+		uint32_t iatRva;    // FirstThunk, resolved addresses once loaded
+	};
+
+	bool parse(const uint8_t* base, size_t size, bool mapped);
+	void index_exports(uint32_t dirRva, uint32_t dirSize);
+	void index_imports(uint32_t dirRva);
+
+	const uint8_t* translate(uint32_t rva, size_t& available) const;
+	std::string_view string_at(uint32_t rva) const;
+	uint64_t read_thunk(uint32_t rva) const;
+
+	template <typename Fn> void for_each_import_module(std::string_view module, Fn&& fn) const;
+
+	const uint8_t* m_base = nullptr;
+	size_t m_size = 0;
+	bool m_mapped = false;
+	bool m_is64 = false;
+	uint32_t m_headersSize = 0;
+
+	const uint8_t* m_sections = nullptr;
+	uint16_t m_numSections = 0;
+
+	uint32_t m_exportDirRva = 0;
+	uint32_t m_exportDirSize = 0;
+	uint32_t m_functionsRva = 0;
+	uint32_t m_numFunctions = 0;
+	uint32_t m_namesRva = 0;
+	uint32_t m_nameOrdinalsRva = 0;
+	uint32_t m_numNames = 0;
+	bool m_exportsHashed = false;
+	std::array<uint16_t, ExportHashSize> m_exportHash{}; // name index + 1, 0 = empty
+
+	uint32_t m_importDirRva = 0;
+	size_t m_numImports = 0;
+	bool m_importsHashed = false;
+	std::array<ImportModule, MaxHashedImports> m_imports{};
+	std::array<uint8_t, ImportHashSize> m_importHash{}; // m_imports index + 1, 0 = empty
+};
+
+// char_traits<char> compares as unsigned char even where char is signed (MSVC), so names past 0x7F sort after ASCII like the linker sorts them
+static_assert(std::string_view("\xE9").compare("z") > 0);
+
+template <typename NameAt, typename Fn>
+void Image::join_exports(size_t count, NameAt&& name_at, Fn&& fn) const
+{
+	size_t nameIdx = 0;
+	size_t idx = 0;
+	while (nameIdx < m_numNames && idx < count)
+	{
+		const int cmp = export_name(nameIdx).compare(name_at(idx));
+		if (cmp < 0)
+		{
+			nameIdx++;
+			continue;
+		}
+		if (cmp > 0)
+		{
+			idx++;
+			continue;
+		}
+
+		fn(idx, export_at(nameIdx));
+		nameIdx++;
+		idx++;
+	}
+}
+};
@@ -0,0 +1,146 @@
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <memory>
+
+#include "Prefetch.hpp"
+
+namespace prefetch
+{
+namespace
+{
+// Large enough that each read is a single big request, small enough to not matter for our working set
+constexpr size_t ChunkSize = 1024 * 1024;
+};
+
+#ifdef _WIN32
+bool SequentialFile::open(const std::filesystem::path& path)
+{
+	close();
+
+	// SEQUENTIAL_SCAN lets the cache manager read ahead of us more aggressively than it would for random access
+	HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size{};
+	if (!GetFileSizeEx(file, &size) || size.QuadPart < 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	m_handle = file;
+	m_size = uint64_t(size.QuadPart);
+	m_open = true;
+	return true;
+}
+
+void SequentialFile::close()
+{
+	if (m_handle)
+		CloseHandle(m_handle);
+
+	m_handle = nullptr;
+	m_size = 0;
+	m_open = false;
+}
+
+size_t SequentialFile::read(void* buffer, size_t size)
+{
+	if (!m_open)
+		return 0;
+
+	DWORD bytesRead = 0;
+	if (!ReadFile(m_handle, buffer, DWORD(std::min<size_t>(size, MAXDWORD)), &bytesRead, NULL))
+		return 0;
+	return bytesRead;
+}
+#else
+bool SequentialFile::open(const std::filesystem::path& path)
+{
+	close();
+
+	const int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat st {};
+	if (fstat(fd, &st) != 0 || st.st_size < 0)
+	{
+		::close(fd);
+		return false;
+	}
+
+#ifdef POSIX_FADV_SEQUENTIAL
+	// Hints only, reading still works the same if they're ignored
+	posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+	posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+#endif
+
+	m_fd = fd;
+	m_size = uint64_t(st.st_size);
+	m_open = true;
+	return true;
+}
+
+void SequentialFile::close()
+{
+	if (m_fd >= 0)
+		::close(m_fd);
+
+	m_fd = -1;
+	m_size = 0;
+	m_open = false;
+}
+
+size_t SequentialFile::read(void* buffer, size_t size)
+{
+	if (!m_open)
+		return 0;
+
+	// A signal landing mid-read isn't the end of the file, just try again
+	ssize_t bytesRead;
+	do
+		bytesRead = ::read(m_fd, buffer, size);
+	while (bytesRead < 0 && errno == EINTR);
+
+	return bytesRead > 0 ? size_t(bytesRead) : 0;
+}
+#endif
+
+Stats warm_files(const std::vector<std::filesystem::path>& paths)
+{
+	Stats stats;
+	if (paths.empty())
+		return stats;
+
+	// Contents are thrown away, only the OS cache filled by reading them matters
+	const auto buffer = std::make_unique<uint8_t[]>(ChunkSize);
+
+	for (const auto& path : paths)
+	{
+		SequentialFile file;
+		if (!file.open(path))
+			continue;
+
+		uint64_t total = 0;
+		while (size_t bytesRead = file.read(buffer.get(), ChunkSize))
+			total += bytesRead;
+
+		stats.bytes += total;
+		if (total == file.size())
+			stats.files++;
+	}
+	return stats;
+}
+};
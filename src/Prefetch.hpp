@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+// Read-ahead of files that are about to be loaded, so their first use is served from the OS file cache instead of waiting on disk
+// Kept free of any Win32/NGX dependencies so it can also be built on other platforms
+namespace prefetch
+{
+// Forward-only reader, opened with whatever hints the platform has for sequential access
+class SequentialFile
+{
+public:
+	SequentialFile() = default;
+	explicit SequentialFile(const std::filesystem::path& path) { open(path); }
+	~SequentialFile() { close(); }
+
+	SequentialFile(const SequentialFile&) = delete;
+	SequentialFile& operator=(const SequentialFile&) = delete;
+
+	bool open(const std::filesystem::path& path);
+	void close();
+
+	bool is_open() const { return m_open; }
+	uint64_t size() const { return m_size; }
+
+	// Returns number of bytes read, 0 once the end of the file is reached (or on error)
+	size_t read(void* buffer, size_t size);
+
+private:
+#ifdef _WIN32
+	void* m_handle = nullptr;
+#else
+	int m_fd = -1;
+#endif
+	uint64_t m_size = 0;
+	bool m_open = false;
+};
+
+struct Stats
+{
+	size_t files = 0; // files that were read all the way through
+	uint64_t bytes = 0;
+};
+
+// Reads each file start to end, files that don't exist or can't be opened are skipped
+Stats warm_files(const std::vector<std::filesystem::path>& paths);
+};
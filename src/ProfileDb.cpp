@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <charconv>
+#include <map>
+
+#include "DLSSTweaks.hpp"
+#include "Log.hpp"
+#include "IniParser.hpp"
+#include "SettingsSchema.hpp"
+#include "SettingsLayers.hpp"
+
+namespace
+{
+std::string to_lower(std::string_view str)
+{
+	std::string result(str);
+	for (auto& c : result)
+		c = ini::to_lower(c);
+	return result;
+}
+
+bool parse_app_id(std::string_view str, unsigned long long& out)
+{
+	int base = 10;
+	if (str.size() > 2 && str[0] == '0' && (str[1] == 'x' || str[1] == 'X'))
+	{
+		str.remove_prefix(2);
+		base = 16;
+	}
+
+	auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), out, base);
+	return ec == std::errc{} && ptr == str.data() + str.size();
+}
+};
+
+std::string ProfileDb::make_key(Kind kind, std::string_view id)
+{
+	id = ini::trim_quotes(id);
+
+	switch (kind)
+	{
+	case Kind::Exe:
+		return "exe:" + to_lower(id);
+	case Kind::AppId:
+	{
+		unsigned long long appId = 0;
+		if (!parse_app_id(id, appId))
+			return {};
+		return "appid:" + std::to_string(appId);
+	}
+	case Kind::ProjectId:
+		return "projectid:" + to_lower(id);
+	}
+
+	return {};
+}
+
+bool ProfileDb::refresh(const std::filesystem::path& path)
+{
+	const auto stamp = utility::GetFileStamp(path);
+	if (path == m_path && stamp == m_stamp)
+		return true;
+
+	m_path = path;
+	m_stamp = stamp;
+	m_text.clear();
+	m_profiles.clear();
+
+	if (!stamp.exists)
+		return true;
+
+	ini::MappedFile file;
+	if (!file.open(path))
+	{
+		m_stamp = {}; // make sure next refresh tries again
+		return false;
+	}
+
+	m_text = file.view();
+	file.close();
+
+	// Sections for the same profile can appear more than once, values from each get combined
+	std::map<std::string, size_t, std::less<>> profileIndices;
+	std::string_view currentSection;
+	IniLayer* currentLayer = nullptr;
+
+	const size_t numErrors = ini::parse(m_text, [&](const ini::Entry& entry) {
+		if (entry.section.data() != currentSection.data() || entry.section.size() != currentSection.size())
+		{
+			currentSection = entry.section;
+			currentLayer = nullptr;
+
+			const size_t separator = entry.section.find(':');
+			if (separator == std::string_view::npos)
+				return true;
+
+			const auto kindName = ini::trim(entry.section.substr(0, separator));
+			const auto id = ini::trim(entry.section.substr(separator + 1));
+
+			std::string key;
+			if (ini::iequals(kindName, "exe"))
+				key = make_key(Kind::Exe, id);
+			else if (ini::iequals(kindName, "appid"))
+				key = make_key(Kind::AppId, id);
+			else if (ini::iequals(kindName, "projectid"))
+				key = make_key(Kind::ProjectId, id);
+
+			if (key.empty())
+			{
+				spdlog::warn("Profiles: unknown profile section [{}], skipping", entry.section);
+				return true;
+			}
+
+			auto [it, inserted] = profileIndices.try_emplace(key, m_profiles.size());
+			if (inserted)
+			{
+				auto layer = std::make_unique<IniLayer>();
+				layer->path = path;
+				layer->stamp = stamp;
+				m_profiles.push_back({ key, std::move(layer) });
+			}
+			currentLayer = m_profiles[it->second].layer.get();
+		}
+
+		if (!currentLayer)
+			return true;
+
+		// Section.Key = value, section name can't contain a period but DLLPathOverrides keys can, so split on the first one
+		const size_t separator = entry.key.find('.');
+		if (separator == std::string_view::npos)
+		{
+			spdlog::warn("Profiles: [{}] {} should be written as Section.Key, skipping", entry.section, entry.key);
+			return true;
+		}
+
+		const auto section = entry.key.substr(0, separator);
+		const auto key = entry.key.substr(separator + 1);
+
+		if (ini::iequals(section, "DLLPathOverrides"))
+			currentLayer->values.push_back({ nullptr, key, ini::trim_quotes(entry.value) });
+		else if (const SettingDef* def = FindSetting(section, key))
+			currentLayer->values.push_back({ def, key, entry.value });
+		else
+			spdlog::warn("Profiles: [{}] unknown setting {}, skipping", entry.section, entry.key);
+
+		return true;
+	});
+
+	if (numErrors)
+		spdlog::debug("{}: skipped {} malformed line(s)", path.filename().string(), numErrors);
+
+	std::sort(m_profiles.begin(), m_profiles.end(), [](const Profile& a, const Profile& b) {
+		return a.key < b.key;
+	});
+
+	spdlog::info("Profiles: read {} profiles from {}", m_profiles.size(), path.string());
+	return true;
+}
+
+const IniLayer* ProfileDb::find(std::string_view key) const
+{
+	if (key.empty())
+		return nullptr;
+
+	auto it = std::lower_bound(m_profiles.begin(), m_profiles.end(), key, [](const Profile& profile, std::string_view key) {
+		return profile.key < key;
+	});
+
+	if (it == m_profiles.end() || it->key != key)
+		return nullptr;
+
+	return it->layer.get();
+}
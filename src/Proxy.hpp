@@ -1,9 +1,21 @@
 #pragma once
+#include <filesystem>
 
 namespace proxy
 {
 extern HMODULE origModule;
 extern bool is_wrapping_nvngx;
+
+// Export we forward to, tables of these are generated from ProxyExports.txt
+struct ExportSlot
+{
+    const char* name;
+    FARPROC* slot;
+};
+size_t resolve_exports(HMODULE module, const ExportSlot* exports, size_t count);
+// Warns about any slots resolve_exports left null, called once the logger is set up
+void log_unresolved_exports();
+
 bool on_attach(HMODULE ourModule);
 void on_detach();
 };
@@ -35,6 +47,9 @@ extern FARPROC NVSDK_NGX_VULKAN_GetParameters_Orig;
 
 namespace proxy_nvngx
 {
+// Folder the driver installed _nvngx.dll into, empty if the NGXCore registry entry couldn't be read
+std::filesystem::path ngx_core_path();
+
 bool on_attach(HMODULE ourModule);
 void on_detach();
 };
@@ -0,0 +1,324 @@
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <unordered_map>
+
+#include "DLSSTweaks.hpp"
+#include "Log.hpp"
+#include "ThreadPolicy.hpp"
+
+namespace service
+{
+namespace
+{
+// Hashed timer wheel: timers are placed into slot (dueTick % WheelSize), so adding/expiring one is O(1) no matter how many there are
+// Timers further out than one revolution (2.56s) just stay in their slot until the wheel comes round to the right tick
+constexpr uint32_t TickMs = 10;
+constexpr size_t WheelSize = 256;
+
+// Slot 0 of the wait array is always the wake event
+constexpr size_t MaxHandles = MAXIMUM_WAIT_OBJECTS - 1;
+
+struct Timer
+{
+	TimerId id;
+	uint64_t dueTick;
+	uint32_t periodMs;
+	Task task;
+};
+
+std::mutex mutex;
+HANDLE wakeEvent = CreateEventW(NULL, FALSE, FALSE, NULL);
+std::atomic<bool> stopRequested = false;
+std::atomic<DWORD> serviceThreadId = 0;
+
+std::vector<Task> postedTasks;
+bool stopped = false; // loop has exited (or is never going to run), posted tasks would never be picked up
+
+std::vector<std::pair<HANDLE, Task>> handles;
+bool handlesChanged = true;
+
+std::array<std::vector<Timer>, WheelSize> wheel;
+std::unordered_map<TimerId, uint64_t> timerDueTicks; // so cancel_timer knows which slot to look in
+TimerId nextTimerId = 1;
+uint64_t currentTick = 0; // last tick that's been expired
+
+uint64_t NowTick()
+{
+	return GetTickCount64() / TickMs;
+}
+
+// Registration calls made from other threads need the loop to wake up & pick them up
+void WakeIfNeeded()
+{
+	if (GetCurrentThreadId() != serviceThreadId)
+		SetEvent(wakeEvent);
+}
+
+void InsertTimer(Timer&& timer)
+{
+	timerDueTicks[timer.id] = timer.dueTick;
+	wheel[timer.dueTick % WheelSize].push_back(std::move(timer));
+}
+
+// Time until the next timer is due, only walks the wheel as far as the first occupied tick
+DWORD NextTimeout()
+{
+	if (timerDueTicks.empty())
+		return INFINITE;
+
+	const uint64_t now = NowTick();
+	for (uint64_t tick = currentTick + 1; tick <= currentTick + WheelSize; tick++)
+	{
+		for (const auto& timer : wheel[tick % WheelSize])
+		{
+			if (timer.dueTick <= tick)
+				return tick <= now ? 0 : DWORD((tick - now) * TickMs);
+		}
+	}
+
+	// Only long timers are pending, check back after a full revolution
+	return DWORD(WheelSize * TickMs);
+}
+
+void RunTimers()
+{
+	std::vector<Task> due;
+	{
+		std::scoped_lock lock(mutex);
+		if (timerDueTicks.empty())
+		{
+			currentTick = NowTick();
+			return;
+		}
+
+		// Periodic timers could land back in a slot that's being walked, so they're only re-armed after the loop
+		std::vector<Timer> rearmed;
+
+		// If the thread was stalled for longer than a revolution, every slot has to be checked once
+		const uint64_t now = NowTick();
+		const uint64_t steps = std::min<uint64_t>(now - currentTick, WheelSize);
+		for (uint64_t i = 1; i <= steps; i++)
+		{
+			auto& slot = wheel[(currentTick + i) % WheelSize];
+			for (auto it = slot.begin(); it != slot.end();)
+			{
+				if (it->dueTick > now)
+				{
+					++it;
+					continue;
+				}
+
+				due.push_back(it->task);
+
+				Timer timer = std::move(*it);
+				it = slot.erase(it);
+				timerDueTicks.erase(timer.id);
+
+				if (timer.periodMs)
+				{
+					timer.dueTick = now + std::max<uint64_t>(1, (timer.periodMs + TickMs - 1) / TickMs);
+					rearmed.push_back(std::move(timer));
+				}
+			}
+		}
+		currentTick = now;
+
+		// Periodic timers are re-armed before running, so the task is able to cancel itself
+		for (auto& timer : rearmed)
+			InsertTimer(std::move(timer));
+	}
+
+	for (auto& task : due)
+		task();
+}
+};
+
+void run()
+{
+	serviceThreadId = GetCurrentThreadId();
+
+	// Nothing we do here is time-critical, stay out of the way of game threads
+	threads::apply();
+
+	{
+		std::scoped_lock lock(mutex);
+		currentTick = NowTick();
+	}
+
+	spdlog::debug("Service thread: running");
+
+	std::vector<HANDLE> waitHandles;
+	while (!stopRequested)
+	{
+		DWORD timeout = INFINITE;
+		{
+			std::scoped_lock lock(mutex);
+			if (handlesChanged)
+			{
+				waitHandles.clear();
+				waitHandles.push_back(wakeEvent);
+				for (const auto& [handle, task] : handles)
+					waitHandles.push_back(handle);
+				handlesChanged = false;
+			}
+			timeout = NextTimeout();
+		}
+
+		const DWORD result = WaitForMultipleObjects(DWORD(waitHandles.size()), waitHandles.data(), FALSE, timeout);
+		if (stopRequested)
+			break;
+
+		if (result == WAIT_OBJECT_0)
+		{
+			std::vector<Task> tasks;
+			{
+				std::scoped_lock lock(mutex);
+				tasks.swap(postedTasks);
+			}
+			for (auto& task : tasks)
+				task();
+		}
+		else if (result > WAIT_OBJECT_0 && result < WAIT_OBJECT_0 + waitHandles.size())
+		{
+			// Copy the task out, it's allowed to remove its own handle while running
+			Task task;
+			{
+				std::scoped_lock lock(mutex);
+				const HANDLE signaled = waitHandles[result - WAIT_OBJECT_0];
+				auto it = std::find_if(handles.begin(), handles.end(), [signaled](const auto& entry) { return entry.first == signaled; });
+				if (it != handles.end())
+					task = it->second;
+			}
+			if (task)
+				task();
+		}
+		else if (result == WAIT_FAILED)
+		{
+			// A handle removed from another thread can get closed before we've woken up & rebuilt the wait array
+			const DWORD error = GetLastError();
+			bool rebuild = false;
+			if (error == ERROR_INVALID_HANDLE)
+			{
+				std::scoped_lock lock(mutex);
+				rebuild = handlesChanged;
+			}
+
+			if (!rebuild)
+			{
+				spdlog::error("Service thread: wait failed with error code {}, stopping", error);
+				break;
+			}
+			spdlog::debug("Service thread: waited on a handle that was just removed, rebuilding handle list");
+		}
+
+		RunTimers();
+	}
+
+	// Anything posted from here on is rejected, tasks that were still queued up are dropped
+	std::vector<Task> dropped;
+	{
+		std::scoped_lock lock(mutex);
+		stopped = true;
+		dropped.swap(postedTasks);
+	}
+
+	spdlog::debug("Service thread: stopped ({} queued task(s) dropped)", dropped.size());
+}
+
+void shutdown()
+{
+	// Called from DLL_PROCESS_DETACH, can't wait for the thread there since it'd need the loader lock we're holding
+	// (during process exit the thread is already gone by this point anyway)
+	{
+		std::scoped_lock lock(mutex);
+		stopRequested = true;
+
+		// If the loop never started nothing else is going to mark it stopped
+		if (!serviceThreadId)
+		{
+			stopped = true;
+			postedTasks.clear();
+		}
+	}
+	SetEvent(wakeEvent);
+}
+
+bool post(Task task)
+{
+	{
+		std::scoped_lock lock(mutex);
+		if (stopped || stopRequested)
+			return false;
+		postedTasks.push_back(std::move(task));
+	}
+	SetEvent(wakeEvent);
+	return true;
+}
+
+TimerId add_timer(uint32_t delayMs, Task task, uint32_t periodMs)
+{
+	TimerId id = 0;
+	{
+		std::scoped_lock lock(mutex);
+		id = nextTimerId++;
+
+		// Round up, timers should never fire early
+		const uint64_t ticks = std::max<uint64_t>(1, (delayMs + TickMs - 1) / TickMs);
+		InsertTimer({ id, NowTick() + ticks, periodMs, std::move(task) });
+	}
+	WakeIfNeeded();
+	return id;
+}
+
+void cancel_timer(TimerId id)
+{
+	std::scoped_lock lock(mutex);
+	auto it = timerDueTicks.find(id);
+	if (it == timerDueTicks.end())
+		return;
+
+	auto& slot = wheel[it->second % WheelSize];
+	std::erase_if(slot, [id](const Timer& timer) { return timer.id == id; });
+	timerDueTicks.erase(it);
+}
+
+bool add_handle(HANDLE handle, Task task)
+{
+	{
+		std::scoped_lock lock(mutex);
+		if (handles.size() >= MaxHandles)
+			return false;
+
+		handles.emplace_back(handle, std::move(task));
+		handlesChanged = true;
+	}
+	WakeIfNeeded();
+	return true;
+}
+
+void remove_handle(HANDLE handle)
+{
+	{
+		std::scoped_lock lock(mutex);
+		std::erase_if(handles, [handle](const auto& entry) { return entry.first == handle; });
+		handlesChanged = true;
+	}
+	WakeIfNeeded();
+}
+
+void settings_changed()
+{
+	const auto current = current_settings();
+	threads::set_policy({ threads::Priority(current->backgroundThreadPriority), current->backgroundThreadEfficiency });
+
+	// Threads started after this get the new policy straight away, but the service thread has to reapply it to itself
+	post([]() {
+		if (!threads::apply())
+			spdlog::debug("Service thread: thread policy could only be partly applied");
+	});
+}
+};
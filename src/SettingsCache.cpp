@@ -0,0 +1,363 @@
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+#include "DLSSTweaks.hpp"
+#include "Log.hpp"
+#include "IniParser.hpp"
+#include "SettingsSchema.hpp"
+#include "resource.h" // TWEAKS_VER_STR
+
+// Binary cache of the fully resolved settings, letting startup skip parsing the INI chain when none of the INIs have changed
+// Layout: header, root INIs, profile exe name, INI dependency list (path/exists/size/mtime), applied profiles, then each SettingsSchema field in table order, then DLLPathOverrides
+// Cache is thrown away if the DLSSTweaks version or the schema layout changes, or if any dependency doesn't match the file on disk
+namespace
+{
+constexpr uint32_t CacheMagic = 0x43575444; // 'DTWC'
+constexpr uint32_t CacheVersion = 4; // 3: missing BaseINIs are listed as dependencies, 4: quality levels no longer store the INI string
+
+struct CacheHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t layoutHash; // schema layout + DLSSTweaks version
+	uint64_t payloadHash; // FNV-1a of everything after the header, catches partially-written caches
+	uint32_t payloadSize;
+	uint32_t reserved;
+};
+
+constexpr uint64_t CacheLayoutHash()
+{
+	uint64_t hash = utility::fnv1a(TWEAKS_VER_STR);
+	for (const auto& def : SettingsSchema)
+	{
+		hash = utility::fnv1a(def.section, hash);
+		hash = utility::fnv1a(def.key, hash);
+		hash = utility::fnv1a(std::string_view("\0", 1), hash);
+		hash ^= uint64_t(def.type);
+	}
+	return hash;
+}
+
+class CacheWriter
+{
+public:
+	template <typename T> void put(const T& value)
+	{
+		const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+		m_data.insert(m_data.end(), bytes, bytes + sizeof(T));
+	}
+
+	void put_string(std::string_view str)
+	{
+		put(uint32_t(str.size()));
+		m_data.insert(m_data.end(), str.begin(), str.end());
+	}
+
+	void put_path(const std::filesystem::path& path)
+	{
+		const auto str = path.u8string();
+		put_string(std::string_view((const char*)str.data(), str.size()));
+	}
+
+	std::vector<uint8_t>& data() { return m_data; }
+
+private:
+	std::vector<uint8_t> m_data;
+};
+
+// Bounds-checked reader, any read past the end puts it into a failed state instead of throwing
+class CacheReader
+{
+public:
+	explicit CacheReader(std::string_view data) : m_data(data) {}
+
+	template <typename T> T get()
+	{
+		T value{};
+		if (m_data.size() < sizeof(T))
+		{
+			m_failed = true;
+			return value;
+		}
+		std::memcpy(&value, m_data.data(), sizeof(T));
+		m_data.remove_prefix(sizeof(T));
+		return value;
+	}
+
+	std::string_view get_string()
+	{
+		const uint32_t size = get<uint32_t>();
+		if (m_failed || m_data.size() < size)
+		{
+			m_failed = true;
+			return {};
+		}
+		const auto str = m_data.substr(0, size);
+		m_data.remove_prefix(size);
+		return str;
+	}
+
+	std::filesystem::path get_path()
+	{
+		const auto str = get_string();
+		return std::filesystem::path(std::u8string_view((const char8_t*)str.data(), str.size()));
+	}
+
+	bool failed() const { return m_failed; }
+
+private:
+	std::string_view m_data;
+	bool m_failed = false;
+};
+};
+
+bool UserSettings::read_cache(const std::filesystem::path& cachePath, const std::vector<std::filesystem::path>& rootInis)
+{
+	// Read the whole cache in one go
+	ini::MappedFile cacheFile;
+	if (!cacheFile.open(cachePath))
+		return false;
+
+	const std::string_view cacheData = cacheFile.view();
+	if (cacheData.size() < sizeof(CacheHeader))
+		return false;
+
+	CacheHeader header;
+	std::memcpy(&header, cacheData.data(), sizeof(header));
+	const std::string_view payload = cacheData.substr(sizeof(header));
+
+	if (header.magic != CacheMagic || header.version != CacheVersion || header.layoutHash != CacheLayoutHash())
+	{
+		spdlog::debug("Config cache: {} is from a different DLSSTweaks version, ignoring", cachePath.filename().string());
+		return false;
+	}
+
+	if (header.payloadSize != payload.size() || header.payloadHash != utility::fnv1a(payload))
+	{
+		spdlog::debug("Config cache: {} is corrupt, ignoring", cachePath.filename().string());
+		return false;
+	}
+
+	CacheReader reader(payload);
+
+	// Root INIs need to match exactly, so a cache made with a different DLL/EXE folder doesn't get used
+	const uint32_t numRoots = reader.get<uint32_t>();
+	if (numRoots != rootInis.size())
+		return false;
+	for (const auto& root : rootInis)
+		if (reader.get_path() != root)
+			return false;
+
+	// Profiles matched against a different EXE (eg. launcher & game sharing a folder) would need a different set applied
+	if (reader.get_string() != profileExeName)
+		return false;
+
+	// Every INI the cached settings were built from (roots, BaseINI chain & missing BaseINIs), all need to be unchanged
+	const uint32_t numDependencies = reader.get<uint32_t>();
+	std::vector<std::filesystem::path> dependencies;
+	std::vector<std::filesystem::path> missing;
+	std::vector<std::pair<std::filesystem::path, utility::FileStamp>> stamps;
+	dependencies.reserve(numDependencies);
+	for (uint32_t i = 0; i < numDependencies && !reader.failed(); i++)
+	{
+		auto path = reader.get_path();
+		utility::FileStamp cached;
+		cached.exists = reader.get<uint8_t>() != 0;
+		cached.size = reader.get<uint64_t>();
+		cached.mtime = reader.get<uint64_t>();
+
+		if (reader.failed() || utility::GetFileStamp(path) != cached)
+		{
+			spdlog::debug("Config cache: {} has changed, cache is out of date", path.string());
+			return false;
+		}
+
+		stamps.emplace_back(path, cached);
+		if (cached.exists)
+			dependencies.push_back(std::move(path));
+		else if (path != profilesPath && std::find(rootInis.begin(), rootInis.end(), path) == rootInis.end())
+			missing.push_back(std::move(path));
+	}
+
+	// Dependencies are all unchanged, read values into a copy first so a truncated cache can't leave settings half-applied
+	UserSettings cached = *this;
+	cached.rootInis = rootInis;
+	cached.appliedProfiles.clear();
+	const uint32_t numProfiles = reader.get<uint32_t>();
+	for (uint32_t i = 0; i < numProfiles && !reader.failed(); i++)
+		cached.appliedProfiles.emplace_back(reader.get_string());
+
+	for (const auto& def : SettingsSchema)
+	{
+		switch (def.type)
+		{
+		case SettingType::Bool:
+			cached.*def.boolField = reader.get<uint8_t>() != 0;
+			break;
+		case SettingType::Int:
+		case SettingType::TriState:
+			cached.*def.intField = reader.get<int32_t>();
+			break;
+		case SettingType::Sharpening:
+		{
+			const bool hasValue = reader.get<uint8_t>() != 0;
+			const float value = reader.get<float>();
+			cached.overrideSharpening = hasValue ? std::optional<float>(value) : std::nullopt;
+			cached.overrideSharpeningForceDisable = reader.get<uint8_t>() != 0;
+			cached.overrideSharpeningString = reader.get_string();
+			break;
+		}
+		case SettingType::QualityLevel:
+		{
+			auto& quality = cached.qualities[def.level];
+			quality.scalingRatio = reader.get<float>();
+			quality.resolution.first = reader.get<int32_t>();
+			quality.resolution.second = reader.get<int32_t>();
+			break;
+		}
+		case SettingType::Preset:
+			cached.qualities[def.level].preset = reader.get<uint32_t>();
+			break;
+		}
+	}
+
+	const uint32_t numOverrides = reader.get<uint32_t>();
+	cached.dllPathOverrides.clear();
+	for (uint32_t i = 0; i < numOverrides && !reader.failed(); i++)
+	{
+		const auto name = reader.get_string();
+		cached.dllPathOverrides[std::string(name)] = reader.get_path();
+	}
+
+	if (reader.failed())
+		return false;
+
+	cached.iniChain = std::move(dependencies);
+	cached.missingInis = std::move(missing);
+	cached.iniStamps = std::move(stamps);
+
+	*this = std::move(cached);
+	publish();
+
+	// Treat everything as changed, this only happens at startup so subscribers need to see all of it anyway
+	changedFields = ~0ull;
+	changedDllOverrides = true;
+	dispatch_changes();
+	return true;
+}
+
+bool UserSettings::write_cache(const std::filesystem::path& cachePath, const std::vector<std::filesystem::path>& rootInis) const
+{
+	CacheWriter writer;
+	writer.put(CacheHeader{});
+
+	writer.put(uint32_t(rootInis.size()));
+	for (const auto& root : rootInis)
+		writer.put_path(root);
+	writer.put_string(profileExeName);
+
+	// Roots, profile database & missing BaseINIs are included even if they don't exist, so creating one later on invalidates the cache
+	std::vector<std::filesystem::path> dependencies = rootInis;
+	if (!profilesPath.empty())
+		dependencies.push_back(profilesPath);
+	for (const auto* paths : { &iniChain, &missingInis })
+		for (const auto& path : *paths)
+			if (std::find(dependencies.begin(), dependencies.end(), path) == dependencies.end())
+				dependencies.push_back(path);
+
+	writer.put(uint32_t(dependencies.size()));
+	for (const auto& path : dependencies)
+	{
+		// Stamps have to be the ones seen when the settings were read, checking the files now could pick up an edit made since
+		const auto it = std::find_if(iniStamps.begin(), iniStamps.end(), [&path](const auto& entry) { return entry.first == path; });
+		if (it == iniStamps.end())
+		{
+			spdlog::debug("Config cache: no stamp recorded for {}, not writing cache", path.string());
+			return false;
+		}
+
+		const auto& stamp = it->second;
+		writer.put_path(path);
+		writer.put(uint8_t(stamp.exists));
+		writer.put(stamp.size);
+		writer.put(stamp.mtime);
+	}
+
+	writer.put(uint32_t(appliedProfiles.size()));
+	for (const auto& key : appliedProfiles)
+		writer.put_string(key);
+
+	for (const auto& def : SettingsSchema)
+	{
+		switch (def.type)
+		{
+		case SettingType::Bool:
+			writer.put(uint8_t(this->*def.boolField));
+			break;
+		case SettingType::Int:
+		case SettingType::TriState:
+			writer.put(int32_t(this->*def.intField));
+			break;
+		case SettingType::Sharpening:
+			writer.put(uint8_t(overrideSharpening.has_value()));
+			writer.put(overrideSharpening.value_or(0.f));
+			writer.put(uint8_t(overrideSharpeningForceDisable));
+			writer.put_string(overrideSharpeningString);
+			break;
+		case SettingType::QualityLevel:
+		{
+			const auto& quality = qualities.at(def.level);
+			writer.put(quality.scalingRatio);
+			writer.put(int32_t(quality.resolution.first));
+			writer.put(int32_t(quality.resolution.second));
+			break;
+		}
+		case SettingType::Preset:
+			writer.put(uint32_t(qualities.at(def.level).preset));
+			break;
+		}
+	}
+
+	writer.put(uint32_t(dllPathOverrides.size()));
+	for (const auto& [name, path] : dllPathOverrides)
+	{
+		writer.put_string(name);
+		writer.put_path(path);
+	}
+
+	auto& data = writer.data();
+	const std::string_view payload((const char*)data.data() + sizeof(CacheHeader), data.size() - sizeof(CacheHeader));
+
+	CacheHeader header{};
+	header.magic = CacheMagic;
+	header.version = CacheVersion;
+	header.layoutHash = CacheLayoutHash();
+	header.payloadHash = utility::fnv1a(payload);
+	header.payloadSize = uint32_t(payload.size());
+	std::memcpy(data.data(), &header, sizeof(header));
+
+	// Folder might not be writable (eg. Program Files), cache is only an optimization so failing here is fine
+	HANDLE file = CreateFileW(cachePath.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		spdlog::debug("Config cache: failed to create {} (error {})", cachePath.string(), GetLastError());
+		return false;
+	}
+
+	DWORD written = 0;
+	const BOOL success = WriteFile(file, data.data(), DWORD(data.size()), &written, NULL);
+	CloseHandle(file);
+
+	if (!success || written != data.size())
+	{
+		spdlog::debug("Config cache: failed to write {}", cachePath.string());
+		return false;
+	}
+
+	spdlog::debug("Config cache: wrote {} ({} bytes, {} INIs)", cachePath.filename().string(), data.size(), dependencies.size());
+	return true;
+}
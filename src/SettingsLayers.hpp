@@ -0,0 +1,68 @@
+#pragma once
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "DLSSTweaks.hpp"
+
+// A single set of INI values, either a whole INI file or one profile out of the profile database
+// Kept around between reloads so that unchanged files (eg. shared BaseINIs) don't need to be read/parsed again
+struct IniLayer
+{
+	struct Value
+	{
+		const SettingDef* def; // null for [DLLPathOverrides] entries
+		std::string_view key;
+		std::string_view value;
+	};
+
+	std::filesystem::path path; // canonical
+	utility::FileStamp stamp;
+	uint32_t generation = 0; // reload that last checked the stamp
+
+	// Owns a copy of the INI text, values below are views into it
+	// (the file can't stay mapped, as that would stop editors from saving over it)
+	std::string text;
+	std::vector<Value> values;
+	std::string_view baseIni;
+};
+
+// Per-game profiles kept inside a single INI next to the DLL, instead of needing a dlsstweaks.ini inside every game folder
+// Sections are named [exe:game.exe], [appid:12345] or [projectid:...], holding Section.Key = value entries, eg. DLSS.ForceDLAA = true
+class ProfileDb
+{
+public:
+	enum class Kind
+	{
+		Exe,
+		AppId,
+		ProjectId,
+	};
+
+	// Builds the lookup key used by find(), ids are case-insensitive & app IDs can be given in decimal or 0x hex
+	static std::string make_key(Kind kind, std::string_view id);
+
+	// Re-reads the database if it's changed since the last call, returns false if it exists but couldn't be read
+	bool refresh(const std::filesystem::path& path);
+
+	// Binary search through the sorted profile list, returns nullptr if there's no profile for key
+	const IniLayer* find(std::string_view key) const;
+
+	bool exists() const { return m_stamp.exists; }
+	const utility::FileStamp& stamp() const { return m_stamp; }
+	size_t size() const { return m_profiles.size(); }
+
+private:
+	struct Profile
+	{
+		std::string key;
+		std::unique_ptr<IniLayer> layer;
+	};
+
+	std::filesystem::path m_path;
+	utility::FileStamp m_stamp;
+	std::string m_text; // values in each profile layer are views into this
+	std::vector<Profile> m_profiles; // sorted by key
+};
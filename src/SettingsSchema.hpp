@@ -0,0 +1,134 @@
+#pragma once
+#include <array>
+#include <climits>
+#include <cstdint>
+#include <string_view>
+
+#include "DLSSTweaks.hpp"
+#include "IniParser.hpp"
+
+// Describes every INI-backed field in UserSettings, so reading/logging/defaults/change tracking are all driven from one table
+// Adding a new setting should only need a field in UserSettings plus a line here (and whatever consumes it)
+enum class SettingType
+{
+	Bool,
+	Int,
+	TriState, // int where 0 = default, >0 = enable, <0 = disable
+	Sharpening,
+	QualityLevel,
+	Preset,
+};
+
+struct SettingDef
+{
+	std::string_view section;
+	std::string_view key;
+	std::string_view logName; // name used by print_to_log
+	SettingType type;
+	double defaultValue;
+	double minValue; // clamp range (double so the full int range can be represented)
+	double maxValue;
+	uint32_t subsystems; // subsystem:: mask of components that need to know when this changes
+
+	bool UserSettings::* boolField = nullptr;
+	int UserSettings::* intField = nullptr;
+	NVSDK_NGX_PerfQuality_Value level = NVSDK_NGX_PerfQuality_Value_MaxPerf; // QualityLevel/Preset only
+};
+
+namespace schema
+{
+constexpr SettingDef Bool(std::string_view section, std::string_view key, bool UserSettings::* field, bool defaultValue, uint32_t subsystems, std::string_view logName = {})
+{
+	return { section, key, logName.empty() ? key : logName, SettingType::Bool, defaultValue ? 1.0 : 0.0, 0.0, 1.0, subsystems, field, nullptr };
+}
+
+constexpr SettingDef Int(std::string_view section, std::string_view key, int UserSettings::* field, int defaultValue, int minValue, int maxValue, uint32_t subsystems)
+{
+	return { section, key, key, SettingType::Int, double(defaultValue), double(minValue), double(maxValue), subsystems, nullptr, field };
+}
+
+constexpr SettingDef TriState(std::string_view section, std::string_view key, int UserSettings::* field, int maxValue, uint32_t subsystems)
+{
+	return { section, key, key, SettingType::TriState, 0.0, -1.0, double(maxValue), subsystems, nullptr, field };
+}
+
+constexpr SettingDef Quality(NVSDK_NGX_PerfQuality_Value level, std::string_view name, float defaultRatio)
+{
+	return { "DLSSQualityLevels", name, name, SettingType::QualityLevel, defaultRatio, DLSS_MinScale, DLSS_MaxScale, subsystem::ResolutionTable, nullptr, nullptr, level };
+}
+
+constexpr SettingDef Preset(NVSDK_NGX_PerfQuality_Value level, std::string_view name)
+{
+	return { "DLSSPresets", name, name, SettingType::Preset, double(NVSDK_NGX_DLSS_Hint_Render_Preset_Default), 0.0, 0.0, subsystem::PresetTable, nullptr, nullptr, level };
+}
+};
+
+inline constexpr std::array SettingsSchema
+{
+	// [DLSS]
+	schema::Bool("DLSS", "ForceDLAA", &UserSettings::forceDLAA, false, subsystem::ResolutionTable),
+	schema::TriState("DLSS", "OverrideAutoExposure", &UserSettings::overrideAutoExposure, 1, subsystem::FeatureFlags),
+	schema::TriState("DLSS", "OverrideAlphaUpscaling", &UserSettings::overrideAlphaUpscaling, 1, subsystem::FeatureFlags),
+	SettingDef{ "DLSS", "OverrideSharpening", "OverrideSharpening", SettingType::Sharpening, 0.0, -1.0, 1.0, subsystem::FeatureFlags },
+	schema::TriState("DLSS", "OverrideHDR", &UserSettings::overrideHDR, 1, subsystem::FeatureFlags),
+	schema::TriState("DLSS", "OverrideDlssHud", &UserSettings::overrideDlssHud, 2, subsystem::DlssHud),
+	schema::Bool("DLSS", "DisableDevWatermark", &UserSettings::disableDevWatermark, false, subsystem::Watermark),
+	schema::Bool("DLSS", "VerboseLogging", &UserSettings::verboseLogging, false, subsystem::LogLevel),
+
+	// [DLSSQualityLevels]
+	schema::Bool("DLSSQualityLevels", "Enable", &UserSettings::overrideQualityLevels, false, subsystem::ResolutionTable, "DLSSQualityLevels enabled"),
+	schema::Quality(NVSDK_NGX_PerfQuality_Value_UltraPerformance, "UltraPerformance", 0.33333334f),
+	schema::Quality(NVSDK_NGX_PerfQuality_Value_MaxPerf, "Performance", 0.5f),
+	schema::Quality(NVSDK_NGX_PerfQuality_Value_Balanced, "Balanced", 0.58f),
+	schema::Quality(NVSDK_NGX_PerfQuality_Value_MaxQuality, "Quality", 0.66666667f),
+	schema::Quality(NVSDK_NGX_PerfQuality_Value_DLAA, "DLAA", 1.0f),
+	schema::Quality(NVSDK_NGX_PerfQuality_Value_UltraQuality, "UltraQuality", 0.f),
+
+	// [DLSSPresets]
+	schema::Preset(NVSDK_NGX_PerfQuality_Value_DLAA, "DLAA"),
+	schema::Preset(NVSDK_NGX_PerfQuality_Value_MaxQuality, "Quality"),
+	schema::Preset(NVSDK_NGX_PerfQuality_Value_Balanced, "Balanced"),
+	schema::Preset(NVSDK_NGX_PerfQuality_Value_MaxPerf, "Performance"),
+	schema::Preset(NVSDK_NGX_PerfQuality_Value_UltraPerformance, "UltraPerformance"),
+	schema::Preset(NVSDK_NGX_PerfQuality_Value_UltraQuality, "UltraQuality"),
+
+	// [Compatibility]
+	schema::Int("Compatibility", "ResolutionOffset", &UserSettings::resolutionOffset, 0, INT_MIN, INT_MAX, subsystem::ResolutionTable),
+	schema::Bool("Compatibility", "DynamicResolutionOverride", &UserSettings::dynamicResolutionOverride, true, subsystem::ResolutionTable),
+	schema::Int("Compatibility", "DynamicResolutionMinOffset", &UserSettings::dynamicResolutionMinOffset, -1, INT_MIN, INT_MAX, subsystem::ResolutionTable),
+	schema::Bool("Compatibility", "DisableIniMonitoring", &UserSettings::disableIniMonitoring, false, subsystem::IniMonitoring),
+	schema::Bool("Compatibility", "OverrideAppId", &UserSettings::overrideAppId, false, subsystem::AppId),
+	schema::Bool("Compatibility", "EnableControlPipe", &UserSettings::enableControlPipe, false, subsystem::ControlPipe),
+	schema::Bool("Compatibility", "PrefetchDlls", &UserSettings::prefetchDlls, false, subsystem::None),
+	schema::Bool("Compatibility", "IATHooks", &UserSettings::iatHooks, false, subsystem::None),
+	schema::Bool("Compatibility", "VTableParamHooks", &UserSettings::vtableParamHooks, false, subsystem::None),
+	schema::Int("Compatibility", "BackgroundThreadPriority", &UserSettings::backgroundThreadPriority, 2, 0, 3, subsystem::ThreadPolicy),
+	schema::Bool("Compatibility", "BackgroundThreadEfficiency", &UserSettings::backgroundThreadEfficiency, false, subsystem::ThreadPolicy),
+};
+
+// changedFields is a 64-bit mask
+static_assert(SettingsSchema.size() <= 64, "SettingsSchema has outgrown UserSettings::changedFields");
+
+constexpr size_t SettingIndex(const SettingDef& def)
+{
+	return size_t(&def - SettingsSchema.data());
+}
+
+// Case-insensitive lookup, returns nullptr for keys that aren't part of the schema
+constexpr const SettingDef* FindSetting(std::string_view section, std::string_view key)
+{
+	for (const auto& def : SettingsSchema)
+		if (ini::iequals(def.key, key) && ini::iequals(def.section, section))
+			return &def;
+	return nullptr;
+}
+
+// Combined subsystem mask for a set of changed fields
+constexpr uint32_t SettingSubsystems(uint64_t fields)
+{
+	uint32_t mask = subsystem::None;
+	for (size_t i = 0; i < SettingsSchema.size(); i++)
+		if (fields & (1ull << i))
+			mask |= SettingsSchema[i].subsystems;
+	return mask;
+}
@@ -0,0 +1,117 @@
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+
+#include "DLSSTweaks.hpp"
+#include "Log.hpp"
+
+namespace startup
+{
+namespace
+{
+struct Mark
+{
+	const char* stage;
+	DWORD threadId;
+	std::atomic<int64_t> ticks; // written last, non-zero once the rest of the mark can be read
+};
+
+// Fixed size so marking never allocates, DllMain marks are taken under the loader lock
+constexpr size_t MaxMarks = 32;
+std::array<Mark, MaxMarks> marks{};
+std::atomic<size_t> numMarks = 0;
+
+int64_t now()
+{
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return counter.QuadPart;
+}
+
+double ticks_to_ms(int64_t ticks)
+{
+	static const double frequency = [] {
+		LARGE_INTEGER freq;
+		QueryPerformanceFrequency(&freq);
+		return double(freq.QuadPart);
+	}();
+	return double(ticks) * 1000.0 / frequency;
+}
+
+// Everything is timed relative to the first mark, which DllMain takes as soon as it's called
+int64_t start_ticks()
+{
+	return numMarks.load(std::memory_order_acquire) ? marks[0].ticks.load(std::memory_order_acquire) : 0;
+}
+
+std::atomic_flag firstNgxInit = ATOMIC_FLAG_INIT;
+std::atomic_flag firstNgxWait = ATOMIC_FLAG_INIT;
+};
+
+void mark(const char* stage)
+{
+	const size_t index = numMarks.fetch_add(1, std::memory_order_acq_rel);
+	if (index >= MaxMarks)
+		return;
+
+	auto& entry = marks[index];
+	entry.stage = stage;
+	entry.threadId = GetCurrentThreadId();
+	entry.ticks.store(now(), std::memory_order_release);
+}
+
+void log_timeline()
+{
+	struct Row
+	{
+		const char* stage;
+		DWORD threadId;
+		int64_t ticks;
+	};
+
+	std::array<Row, MaxMarks> rows;
+	size_t numRows = 0;
+
+	const size_t count = std::min(numMarks.load(std::memory_order_acquire), MaxMarks);
+	for (size_t i = 0; i < count; i++)
+	{
+		const int64_t ticks = marks[i].ticks.load(std::memory_order_acquire);
+		if (ticks)
+			rows[numRows++] = { marks[i].stage, marks[i].threadId, ticks };
+	}
+
+	if (!numRows)
+		return;
+
+	// Marks from different threads can land slightly out of order
+	std::sort(rows.begin(), rows.begin() + numRows, [](const Row& a, const Row& b) { return a.ticks < b.ticks; });
+
+	const int64_t start = rows[0].ticks;
+	spdlog::debug("Startup: {:<28} {:>10} {:>10}  thread", "stage", "ms", "+ms");
+	for (size_t i = 0; i < numRows; i++)
+	{
+		const double at = ticks_to_ms(rows[i].ticks - start);
+		const double delta = i > 0 ? ticks_to_ms(rows[i].ticks - rows[i - 1].ticks) : 0.0;
+		spdlog::debug("Startup: {:<28} {:>10.3f} {:>10.3f}  {}", rows[i].stage, at, delta, rows[i].threadId);
+	}
+}
+
+void on_ngx_wait()
+{
+	if (!firstNgxWait.test_and_set(std::memory_order_relaxed))
+		mark("NGX call waiting on init");
+}
+
+void on_ngx_init()
+{
+	if (firstNgxInit.test_and_set(std::memory_order_relaxed))
+		return;
+
+	// Timeline has usually been written long before the game gets to this, so it gets its own line
+	mark("first NGX init");
+	spdlog::info("Startup: first NGX init {:.1f}ms after DllMain", ticks_to_ms(now() - start_ticks()));
+}
+};
@@ -0,0 +1,358 @@
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <process.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <vector>
+
+#include "ThreadPolicy.hpp"
+
+namespace threads
+{
+namespace
+{
+// Packed so the whole policy can be swapped atomically
+std::atomic<uint32_t> currentPolicy = uint32_t(Priority::Lowest);
+
+uint32_t pack(const Policy& policy)
+{
+	return uint32_t(policy.priority) | (policy.efficiency ? 0x100u : 0u);
+}
+
+Policy unpack(uint32_t packed)
+{
+	return { Priority(packed & 0xFF), (packed & 0x100u) != 0 };
+}
+
+struct StartInfo
+{
+	Entry entry;
+	void* param;
+	Policy policy;
+};
+
+void run(StartInfo* info)
+{
+	const StartInfo start = *info;
+	delete info;
+
+	apply(start.policy);
+	start.entry(start.param);
+}
+
+#ifdef _WIN32
+int win32_priority(Priority priority)
+{
+	switch (priority)
+	{
+	case Priority::Normal:
+		return THREAD_PRIORITY_NORMAL;
+	case Priority::BelowNormal:
+		return THREAD_PRIORITY_BELOW_NORMAL;
+	case Priority::Lowest:
+		return THREAD_PRIORITY_LOWEST;
+	default:
+		return THREAD_PRIORITY_IDLE;
+	}
+}
+
+// Looked up at runtime, SetThreadInformation needs Win8+ & CPU sets need Win10+
+using SetThreadInformationFn = BOOL(WINAPI*)(HANDLE, THREAD_INFORMATION_CLASS, LPVOID, DWORD);
+using GetSystemCpuSetInformationFn = BOOL(WINAPI*)(PSYSTEM_CPU_SET_INFORMATION, ULONG, PULONG, HANDLE, ULONG);
+using SetThreadSelectedCpuSetsFn = BOOL(WINAPI*)(HANDLE, const ULONG*, ULONG);
+
+FARPROC kernel32_proc(const char* name)
+{
+	static HMODULE kernel32 = GetModuleHandleW(L"kernel32.dll");
+	return kernel32 ? GetProcAddress(kernel32, name) : nullptr;
+}
+
+// CPU set IDs of the lowest efficiency class, empty if every core is the same class (no hybrid CPU)
+const std::vector<ULONG>& efficiency_cpu_sets()
+{
+	static const std::vector<ULONG> cpuSets = [] {
+		std::vector<ULONG> result;
+
+		auto* GetSystemCpuSetInformation = (GetSystemCpuSetInformationFn)kernel32_proc("GetSystemCpuSetInformation");
+		if (!GetSystemCpuSetInformation)
+			return result;
+
+		ULONG length = 0;
+		GetSystemCpuSetInformation(nullptr, 0, &length, GetCurrentProcess(), 0);
+		if (!length)
+			return result;
+
+		std::vector<uint8_t> buffer(length);
+		if (!GetSystemCpuSetInformation((PSYSTEM_CPU_SET_INFORMATION)buffer.data(), length, &length, GetCurrentProcess(), 0))
+			return result;
+
+		BYTE minClass = 0xFF;
+		BYTE maxClass = 0;
+		for (ULONG offset = 0; offset < length;)
+		{
+			const auto* info = (PSYSTEM_CPU_SET_INFORMATION)&buffer[offset];
+			if (info->Type == CpuSetInformation)
+			{
+				minClass = std::min(minClass, info->CpuSet.EfficiencyClass);
+				maxClass = std::max(maxClass, info->CpuSet.EfficiencyClass);
+			}
+			offset += info->Size;
+		}
+
+		if (minClass >= maxClass)
+			return result;
+
+		for (ULONG offset = 0; offset < length;)
+		{
+			const auto* info = (PSYSTEM_CPU_SET_INFORMATION)&buffer[offset];
+			if (info->Type == CpuSetInformation && info->CpuSet.EfficiencyClass == minClass)
+				result.push_back(info->CpuSet.Id);
+			offset += info->Size;
+		}
+		return result;
+	}();
+	return cpuSets;
+}
+
+bool apply_efficiency(bool enable)
+{
+	bool success = true;
+
+	// EcoQoS: lets the scheduler run us at lower clocks / on efficiency cores
+	if (auto* SetThreadInformation = (SetThreadInformationFn)kernel32_proc("SetThreadInformation"))
+	{
+		THREAD_POWER_THROTTLING_STATE state{};
+		state.Version = THREAD_POWER_THROTTLING_CURRENT_VERSION;
+		state.ControlMask = THREAD_POWER_THROTTLING_EXECUTION_SPEED;
+		state.StateMask = enable ? THREAD_POWER_THROTTLING_EXECUTION_SPEED : 0;
+		success &= bool(SetThreadInformation(GetCurrentThread(), ThreadPowerThrottling, &state, sizeof(state)));
+	}
+	else if (enable)
+		success = false;
+
+	// Only a preference, the scheduler can still use other cores if the efficiency ones are busy
+	const auto& cpuSets = efficiency_cpu_sets();
+	if (!cpuSets.empty())
+	{
+		if (auto* SetThreadSelectedCpuSets = (SetThreadSelectedCpuSetsFn)kernel32_proc("SetThreadSelectedCpuSets"))
+		{
+			if (enable)
+				success &= bool(SetThreadSelectedCpuSets(GetCurrentThread(), cpuSets.data(), ULONG(cpuSets.size())));
+			else
+				success &= bool(SetThreadSelectedCpuSets(GetCurrentThread(), nullptr, 0));
+		}
+	}
+
+	return success;
+}
+
+unsigned int __stdcall thread_start(void* param)
+{
+	run((StartInfo*)param);
+	return 0;
+}
+#else
+#ifdef __linux__
+int nice_value(Priority priority)
+{
+	switch (priority)
+	{
+	case Priority::Normal:
+		return 0;
+	case Priority::BelowNormal:
+		return 5;
+	case Priority::Lowest:
+		return 10;
+	default:
+		return 19;
+	}
+}
+
+// CPUs with less than the highest cpu_capacity, empty if every core is the same (or the kernel doesn't report capacities)
+const std::vector<int>& efficiency_cpus()
+{
+	static const std::vector<int> cpus = [] {
+		std::vector<int> capacities;
+		for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+		{
+			char path[64];
+			snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpu_capacity", cpu);
+			FILE* file = fopen(path, "r");
+			if (!file)
+				break;
+
+			int capacity = 0;
+			if (fscanf(file, "%d", &capacity) != 1)
+				capacity = 0;
+			fclose(file);
+			capacities.push_back(capacity);
+		}
+
+		std::vector<int> result;
+		int maxCapacity = 0;
+		for (const int capacity : capacities)
+			maxCapacity = std::max(maxCapacity, capacity);
+
+		for (size_t cpu = 0; cpu < capacities.size(); cpu++)
+			if (capacities[cpu] > 0 && capacities[cpu] < maxCapacity)
+				result.push_back(int(cpu));
+		return result;
+	}();
+	return cpus;
+}
+#endif
+
+void* thread_start(void* param)
+{
+	run((StartInfo*)param);
+	return nullptr;
+}
+#endif
+};
+
+void set_policy(const Policy& policy)
+{
+	currentPolicy.store(pack(policy), std::memory_order_relaxed);
+}
+
+Policy policy()
+{
+	return unpack(currentPolicy.load(std::memory_order_relaxed));
+}
+
+#ifdef _WIN32
+bool apply(const Policy& policy)
+{
+	bool success = bool(SetThreadPriority(GetCurrentThread(), win32_priority(policy.priority)));
+	success &= apply_efficiency(policy.efficiency);
+	return success;
+}
+
+bool Thread::start(Entry entry, void* param, const Policy& policy)
+{
+	detach();
+
+	auto* info = new StartInfo{ entry, param, policy };
+	const uintptr_t handle = _beginthreadex(NULL, 0, thread_start, info, 0, NULL);
+	if (!handle)
+	{
+		delete info;
+		return false;
+	}
+
+	m_handle = handle;
+	m_joinable = true;
+	return true;
+}
+
+void Thread::join()
+{
+	if (!m_joinable)
+		return;
+
+	WaitForSingleObject((HANDLE)m_handle, INFINITE);
+	CloseHandle((HANDLE)m_handle);
+	m_handle = 0;
+	m_joinable = false;
+}
+
+void Thread::detach()
+{
+	if (!m_joinable)
+		return;
+
+	CloseHandle((HANDLE)m_handle);
+	m_handle = 0;
+	m_joinable = false;
+}
+#else
+static_assert(sizeof(pthread_t) <= sizeof(uintptr_t), "pthread_t doesn't fit in Thread::m_handle");
+
+bool apply(const Policy& policy)
+{
+#ifdef __linux__
+	// Linux applies nice values per-thread, SCHED_IDLE is the closest thing to an idle priority class
+	bool success = true;
+
+	sched_param param{};
+	success &= pthread_setschedparam(pthread_self(), policy.priority == Priority::Idle ? SCHED_IDLE : SCHED_OTHER, &param) == 0;
+
+	// Raising the nice value back down needs privileges, so going back to Normal may fail
+	success &= setpriority(PRIO_PROCESS, id_t(syscall(SYS_gettid)), nice_value(policy.priority)) == 0;
+
+	const auto& cpus = efficiency_cpus();
+	if (!cpus.empty())
+	{
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		if (policy.efficiency)
+		{
+			for (const int cpu : cpus)
+				CPU_SET(cpu, &set);
+		}
+		else
+		{
+			for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+				CPU_SET(cpu, &set);
+		}
+		success &= pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+	}
+	return success;
+#else
+	// No per-thread nice elsewhere, only the scheduling priority can be lowered
+	sched_param param{};
+	param.sched_priority = sched_get_priority_min(SCHED_OTHER);
+	return policy.priority == Priority::Normal || pthread_setschedparam(pthread_self(), SCHED_OTHER, &param) == 0;
+#endif
+}
+
+bool Thread::start(Entry entry, void* param, const Policy& policy)
+{
+	detach();
+
+	auto* info = new StartInfo{ entry, param, policy };
+	pthread_t thread;
+	if (pthread_create(&thread, nullptr, thread_start, info) != 0)
+	{
+		delete info;
+		return false;
+	}
+
+	m_handle = uintptr_t(thread);
+	m_joinable = true;
+	return true;
+}
+
+void Thread::join()
+{
+	if (!m_joinable)
+		return;
+
+	pthread_join(pthread_t(m_handle), nullptr);
+	m_handle = 0;
+	m_joinable = false;
+}
+
+void Thread::detach()
+{
+	if (!m_joinable)
+		return;
+
+	pthread_detach(pthread_t(m_handle));
+	m_handle = 0;
+	m_joinable = false;
+}
+#endif
+};
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+
+// Scheduling policy for every thread we start, so our background work stays out of the way of the game's own threads
+// Kept free of any Win32/NGX dependencies so it can also be built on other platforms
+namespace threads
+{
+enum class Priority
+{
+	Normal,
+	BelowNormal,
+	Lowest,
+	Idle,
+};
+
+struct Policy
+{
+	Priority priority = Priority::Lowest;
+	bool efficiency = false; // prefer efficiency cores & let the OS power-throttle us, where supported
+};
+
+// Policy used by threads started after this, threads that are already running pick it up next time they call apply()
+void set_policy(const Policy& policy);
+Policy policy();
+
+// Applies to the calling thread, returns false if any part of the policy couldn't be applied
+bool apply(const Policy& policy);
+inline bool apply() { return apply(policy()); }
+
+using Entry = void (*)(void* param);
+
+// Thread that has its policy applied before entry gets to run
+// Threads that are never joined must be detached (or left to the destructor, which detaches)
+class Thread
+{
+public:
+	Thread() = default;
+	~Thread() { detach(); }
+
+	Thread(const Thread&) = delete;
+	Thread& operator=(const Thread&) = delete;
+
+	bool start(Entry entry, void* param) { return start(entry, param, policy()); }
+	bool start(Entry entry, void* param, const Policy& policy);
+
+	bool joinable() const { return m_joinable; }
+	void join();
+	void detach();
+
+private:
+	uintptr_t m_handle = 0; // HANDLE on Windows, pthread_t elsewhere
+	bool m_joinable = false;
+};
+};
@@ -1,73 +1,366 @@
-#include <spdlog/spdlog.h>
-#include <ini.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
 
 #include "DLSSTweaks.hpp"
+#include "Log.hpp"
+#include "IniParser.hpp"
+#include "SettingsSchema.hpp"
+#include "SettingsLayers.hpp"
 
-void UserSettings::print_to_log()
+UserSettings::UserSettings()
 {
-	using namespace utility;
+	reset_to_defaults();
 
-	spdlog::info("Settings:");
-	spdlog::info(" - VerboseLogging: {}", verboseLogging ? "true" : "false");
-	spdlog::info(" - ForceDLAA: {}{}", forceDLAA ? "true" : "false", overrideQualityLevels ? " (overridden by DLSSQualityLevels section)" : "");
-	spdlog::info(" - OverrideAutoExposure: {}", overrideAutoExposure == 0 ? "default" : (overrideAutoExposure > 0 ? "enable" : "disable"));
-	spdlog::info(" - OverrideAlphaUpscaling: {}", overrideAlphaUpscaling == 0 ? "default" : (overrideAlphaUpscaling > 0 ? "enable" : "disable"));
-	if (overrideSharpeningForceDisable)
-		spdlog::info(" - OverrideSharpening: disable (force disabling sharpness flag)");
-	else if (overrideSharpening.has_value())
-		spdlog::info(" - OverrideSharpening: {}", *overrideSharpening);
-	spdlog::info(" - OverrideAppId: {}", overrideAppId ? "true" : "false");
-	spdlog::info(" - OverrideDlssHud: {}", overrideDlssHud == 0 ? "default" : (overrideDlssHud > 0 ? "enable" : "disable"));
-	spdlog::info(" - DisableDevWatermark: {}", disableDevWatermark ? "true" : "false");
-	spdlog::info(" - ResolutionOffset: {}", resolutionOffset);
-	spdlog::info(" - DynamicResolutionOverride: {}", dynamicResolutionOverride ? "true" : "false");
-	spdlog::info(" - DynamicResolutionMinOffset: {}", dynamicResolutionMinOffset);
-	spdlog::info(" - DisableIniMonitoring: {}", disableIniMonitoring ? "true" : "false");
-	spdlog::info(" - DLSSQualityLevels enabled: {}", overrideQualityLevels ? "true" : "false");
+	// Everything counts as changed until the first dispatch, so each subscriber gets to see the initial settings
+	changedFields = ~0ull;
+	changedDllOverrides = true;
+}
 
-	if (overrideQualityLevels)
+void UserSettings::reset_to_defaults()
+{
+	for (const auto& def : SettingsSchema)
 	{
-		for(const auto& quality : settings.qualities)
+		bool changed = false;
+		switch (def.type)
+		{
+		case SettingType::Bool:
+			changed = std::exchange(this->*def.boolField, def.defaultValue != 0.0) != (def.defaultValue != 0.0);
+			break;
+		case SettingType::Int:
+		case SettingType::TriState:
+			changed = std::exchange(this->*def.intField, int(def.defaultValue)) != int(def.defaultValue);
+			break;
+		case SettingType::Sharpening:
+			changed = read_sharpening("ignore");
+			break;
+		case SettingType::QualityLevel:
 		{
-			auto& res = quality.second.resolution;
-			if (utility::ValidResolution(res))
-				spdlog::info("  - {} resolution: {}x{}", quality.second.name, res.first, res.second);
-			else
-				spdlog::info("  - {} ratio: {}", quality.second.name, quality.second.scalingRatio);
+			auto& quality = qualities[def.level];
+			changed = quality.scalingRatio != float(def.defaultValue) || utility::ValidResolution(quality.resolution);
+			quality.scalingRatio = float(def.defaultValue);
+			quality.resolution = { 0,0 };
+			break;
+		}
+		case SettingType::Preset:
+			changed = std::exchange(qualities[def.level].preset, unsigned(def.defaultValue)) != unsigned(def.defaultValue);
+			break;
 		}
+
+		if (changed)
+			changedFields |= 1ull << SettingIndex(def);
+	}
+
+	if (!dllPathOverrides.empty())
+	{
+		dllPathOverrides.clear();
+		changedDllOverrides = true;
+	}
+}
+
+namespace
+{
+// Value parsers shared by apply_value & valid_value, so the control pipe accepts exactly what an INI read would
+enum class SharpeningMode
+{
+	Ignore,
+	Disable,
+	Value,
+};
+
+bool parse_sharpening(std::string_view value, SharpeningMode& mode, float& sharpening)
+{
+	if (value.empty() || ini::iequals(value, "default") || ini::iequals(value, "ignore") || ini::iequals(value, "ignored"))
+	{
+		mode = SharpeningMode::Ignore;
+		return true;
+	}
+	if (ini::iequals(value, "disable") || ini::iequals(value, "disabled"))
+	{
+		mode = SharpeningMode::Disable;
+		return true;
+	}
+
+	try
+	{
+		sharpening = std::clamp(utility::stof_nolocale(value, true), -1.0f, 1.0f);
+		mode = SharpeningMode::Value;
+		return true;
+	}
+	catch (const std::exception&)
+	{
+		return false;
+	}
+}
+
+// Either a WxH resolution, or a scaling ratio (resolution is left as 0x0 then)
+bool parse_quality_level(std::string_view value, std::pair<int, int>& resolution, float& scalingRatio)
+{
+	resolution = utility::ParseResolution(value);
+	if (utility::ValidResolution(resolution))
+		return true;
+
+	resolution = { 0,0 };
+	try
+	{
+		scalingRatio = std::clamp(utility::stof_nolocale(value, true), DLSS_MinScale, DLSS_MaxScale);
+		return true;
 	}
+	catch (const std::exception&)
+	{
+		return false;
+	}
+}
 
-	// only print presets if any of them have been changed
+// Anything other than a preset letter falls back to Default in an INI, so only an explicit "Default" (or empty value) is treated as valid for it here
+bool valid_preset(std::string_view value)
+{
+	return value.empty() || ini::iequals(value, "default") ||
+		utility::DLSS_PresetNameToEnum(value) != NVSDK_NGX_DLSS_Hint_Render_Preset_Default;
+}
+};
+
+bool UserSettings::valid_value(const SettingDef& def, std::string_view value)
+{
+	switch (def.type)
+	{
+	case SettingType::Bool:
+	{
+		bool result;
+		return ini::parse_bool(value, result);
+	}
+	case SettingType::Int:
+	case SettingType::TriState:
+	{
+		int result;
+		return ini::parse_int(value, result);
+	}
+	case SettingType::Sharpening:
+	{
+		SharpeningMode mode;
+		float sharpening;
+		return parse_sharpening(ini::trim_quotes(value), mode, sharpening);
+	}
+	case SettingType::QualityLevel:
+	{
+		std::pair<int, int> resolution;
+		float scalingRatio;
+		return parse_quality_level(ini::trim_quotes(value), resolution, scalingRatio);
+	}
+	case SettingType::Preset:
+		return valid_preset(ini::trim_quotes(value));
+	}
+	return false;
+}
+
+bool UserSettings::apply_value(const SettingDef& def, std::string_view value)
+{
 	bool changed = false;
-	for (const auto& [level, quality] : qualities)
+	switch (def.type)
+	{
+	case SettingType::Bool:
 	{
-		if (quality.preset != NVSDK_NGX_DLSS_Hint_Render_Preset_Default)
+		bool newValue = this->*def.boolField;
+		if (!ini::parse_bool(value, newValue))
 		{
-			changed = true;
-			break;
+			spdlog::warn("{}.{}: invalid value \"{}\" specified, leaving value as {}", def.section, def.key, value, newValue);
+			return false;
+		}
+		changed = std::exchange(this->*def.boolField, newValue) != newValue;
+		break;
+	}
+	case SettingType::Int:
+	case SettingType::TriState:
+	{
+		int newValue = this->*def.intField;
+		if (!ini::parse_int(value, newValue))
+		{
+			spdlog::warn("{}.{}: invalid value \"{}\" specified, leaving value as {}", def.section, def.key, value, newValue);
+			return false;
 		}
+		newValue = std::clamp(newValue, int(def.minValue), int(def.maxValue));
+		changed = std::exchange(this->*def.intField, newValue) != newValue;
+		break;
+	}
+	case SettingType::Sharpening:
+		changed = read_sharpening(ini::trim_quotes(value));
+		break;
+	case SettingType::QualityLevel:
+		changed = read_quality_level(qualities[def.level], ini::trim_quotes(value));
+		break;
+	case SettingType::Preset:
+	{
+		const unsigned int preset = utility::DLSS_PresetNameToEnum(ini::trim_quotes(value));
+		changed = std::exchange(qualities[def.level].preset, preset) != preset;
+		break;
+	}
 	}
 
 	if (changed)
+		changedFields |= 1ull << SettingIndex(def);
+
+	return changed;
+}
+
+namespace
+{
+void update_log_level()
+{
+	auto log_level = current_settings()->verboseLogging ? spdlog::level::debug : spdlog::level::info;
+#ifdef _DEBUG
+	log_level = spdlog::level::debug;
+#endif
+	// also applies to the default logger, so works the same with MiniLog
+	spdlog::set_level(log_level);
+}
+
+// Components that need to act when settings change, along with the subsystems each of them depends on
+// (HUD/resolution/preset overrides read settings directly from their hooks each call, so have nothing to refresh)
+struct SettingsSubscriber
+{
+	uint32_t subsystems;
+	void (*callback)();
+};
+
+constexpr SettingsSubscriber SettingsSubscribers[] =
+{
+	{ subsystem::LogLevel, update_log_level },
+	{ subsystem::Watermark, nvngx_dlssg::settings_changed },
+	{ subsystem::ControlPipe, control::settings_changed },
+	{ subsystem::DllOverrides, dll_overrides::settings_changed },
+	{ subsystem::ThreadPolicy, service::settings_changed },
+};
+};
+
+uint32_t UserSettings::dispatch_changes()
+{
+	const uint32_t changed = take_changes();
+	if (!changed)
 	{
-		spdlog::info(" - DLSSPresets:");
-		for (const auto& kvp : qualities)
+		spdlog::debug("Settings: no changes to apply");
+		return changed;
+	}
+
+	spdlog::debug("Settings: changed subsystems mask 0x{:X}", changed);
+
+	for (const auto& subscriber : SettingsSubscribers)
+		if (changed & subscriber.subsystems)
+			subscriber.callback();
+
+	return changed;
+}
+
+uint32_t UserSettings::take_changes()
+{
+	uint32_t mask = SettingSubsystems(std::exchange(changedFields, 0));
+	if (std::exchange(changedDllOverrides, false))
+		mask |= subsystem::DllOverrides;
+	return mask;
+}
+
+std::string UserSettings::format_value(const SettingDef& def) const
+{
+	switch (def.type)
+	{
+	case SettingType::Bool:
+		return (this->*def.boolField) ? "true" : "false";
+	case SettingType::Int:
+	case SettingType::TriState:
+		return std::to_string(this->*def.intField);
+	case SettingType::Sharpening:
+		return overrideSharpeningString.empty() ? "ignore" : overrideSharpeningString;
+	case SettingType::QualityLevel:
+	{
+		const auto& quality = qualities.at(def.level);
+		if (utility::ValidResolution(quality.resolution))
+			return fmt::format("{}x{}", quality.resolution.first, quality.resolution.second);
+		return fmt::format("{}", quality.scalingRatio);
+	}
+	case SettingType::Preset:
+		return utility::DLSS_PresetEnumToName(qualities.at(def.level).preset);
+	}
+	return {};
+}
+
+void UserSettings::print_to_log() const
+{
+	using namespace utility;
+
+	spdlog::info("Settings:");
+
+	bool presetsPrinted = false;
+	for (const auto& def : SettingsSchema)
+	{
+		switch (def.type)
+		{
+		case SettingType::Bool:
 		{
-			if(kvp.second.preset != NVSDK_NGX_DLSS_Hint_Render_Preset_Default)
+			const char* note = (def.boolField == &UserSettings::forceDLAA && overrideQualityLevels) ? " (overridden by DLSSQualityLevels section)" : "";
+			spdlog::info(" - {}: {}{}", def.logName, (this->*def.boolField) ? "true" : "false", note);
+			break;
+		}
+		case SettingType::Int:
+			spdlog::info(" - {}: {}", def.logName, this->*def.intField);
+			break;
+		case SettingType::TriState:
+		{
+			const int value = this->*def.intField;
+			spdlog::info(" - {}: {}", def.logName, value == 0 ? "default" : (value > 0 ? "enable" : "disable"));
+			break;
+		}
+		case SettingType::Sharpening:
+			if (overrideSharpeningForceDisable)
+				spdlog::info(" - {}: disable (force disabling sharpness flag)", def.logName);
+			else if (overrideSharpening.has_value())
+				spdlog::info(" - {}: {}", def.logName, *overrideSharpening);
+			break;
+		case SettingType::QualityLevel:
+			if (overrideQualityLevels)
+			{
+				const auto& quality = qualities[def.level];
+				if (utility::ValidResolution(quality.resolution))
+					spdlog::info("  - {} resolution: {}x{}", quality.name, quality.resolution.first, quality.resolution.second);
+				else
+					spdlog::info("  - {} ratio: {}", quality.name, quality.scalingRatio);
+			}
+			break;
+		case SettingType::Preset:
+		{
+			// only print presets if any of them have been changed
+			if (std::exchange(presetsPrinted, true))
+				break;
+
+			bool changed = false;
+			for (const auto& [level, quality] : qualities)
+				changed |= quality.preset != NVSDK_NGX_DLSS_Hint_Render_Preset_Default;
+
+			if (!changed)
 			{
-				spdlog::info("  - {}: {}", kvp.second.name, DLSS_PresetEnumToName(kvp.second.preset));
+				spdlog::info(" - DLSSPresets: default");
+				break;
 			}
+
+			spdlog::info(" - DLSSPresets:");
+			for (const auto& preset : SettingsSchema)
+			{
+				if (preset.type != SettingType::Preset)
+					continue;
+				const auto& quality = qualities[preset.level];
+				if (quality.preset != NVSDK_NGX_DLSS_Hint_Render_Preset_Default)
+					spdlog::info("  - {}: {}", quality.name, DLSS_PresetEnumToName(quality.preset));
+			}
+			break;
+		}
 		}
-	}
-	else
-	{
-		spdlog::info(" - DLSSPresets: default");
 	}
 
-	if (!settings.dllPathOverrides.empty())
+	if (!dllPathOverrides.empty())
 	{
 		spdlog::info(" - DLLPathOverrides:");
-		for (auto& pair : settings.dllPathOverrides)
+		for (auto& pair : dllPathOverrides)
 			spdlog::info("  - {} -> {}", pair.first, pair.second.string());
 	}
 	else
@@ -76,267 +369,475 @@ void UserSettings::print_to_log()
 	}
 }
 
-bool UserSettings::read(const std::filesystem::path& iniPath, int numInisRead)
+namespace
 {
-	using namespace utility;
+class IniLayerCache
+{
+public:
+	enum class Result
+	{
+		Ok,
+		Missing,
+		Failed,
+	};
 
-	const std::wstring iniPathStr = iniPath.wstring();
+	// Starts a new reload, files will be checked for changes at most once until the next call
+	void begin_reload()
+	{
+		m_generation++;
+	}
 
-	// Read INI via FILE* since INIReader doesn't support wstring
-	FILE* iniFile;
-	if (_wfopen_s(&iniFile, iniPathStr.c_str(), L"r") != 0 || !iniFile)
-		return false;
+	// Paths are resolved through any ./.. or links once & remembered, so the same file reached via different paths is treated the same
+	const std::filesystem::path& canonicalize(const std::filesystem::path& path)
+	{
+		auto it = m_canonical.find(path);
+		if (it != m_canonical.end())
+			return it->second;
+
+		std::error_code ec;
+		auto canonical = std::filesystem::weakly_canonical(path, ec);
+		if (ec)
+			canonical = std::filesystem::absolute(path, ec);
+		if (ec)
+			canonical = path;
+
+		return m_canonical.emplace(path, std::move(canonical)).first->second;
+	}
 
-	inih::INIReader ini(iniFile);
-	fclose(iniFile);
+	Result load(const std::filesystem::path& canonicalPath, const IniLayer*& out)
+	{
+		auto& layer = m_layers[canonicalPath];
+		if (layer && layer->generation == m_generation)
+		{
+			out = layer.get();
+			return Result::Ok;
+		}
 
-	// [DLSSTweaks]
+		const auto stamp = utility::GetFileStamp(canonicalPath);
+		if (!stamp.exists)
+		{
+			layer.reset();
+			return Result::Missing;
+		}
 
-	// BaseINI: specifies an INI file which will be read in before the rest of the INI
-	// acting as a sort of global config file if the path has been set up
-	auto baseIni = utility::ini_get_string_safe(ini, "DLSSTweaks", "BaseINI", "");
-	if (!baseIni.empty())
-	{
-		// make sure we aren't trying to read in the current INI that we're reading...
-		if (std::filesystem::absolute(iniPath) != std::filesystem::absolute(baseIni))
+		if (layer && layer->stamp == stamp)
 		{
-			if (numInisRead > 10)
-				spdlog::error("BaseINI: followed too many base INIs, might be caught in a loop, skipping further base INIs..");
-			else
-			{
-				if (read(baseIni, numInisRead + 1))
-					spdlog::info("Config read from {}", baseIni);
-			}
+			spdlog::debug("Config unchanged, reusing {}", canonicalPath.string());
+			layer->generation = m_generation;
+			out = layer.get();
+			return Result::Ok;
 		}
+
+		ini::MappedFile iniFile;
+		if (!iniFile.open(canonicalPath))
+			return Result::Failed;
+
+		auto newLayer = std::make_unique<IniLayer>();
+		newLayer->path = canonicalPath;
+		newLayer->stamp = stamp;
+		newLayer->generation = m_generation;
+		newLayer->text = iniFile.view();
+		iniFile.close();
+
+		// Look up each key in the schema now, merging the layer later on then just needs to walk through the values
+		const size_t numErrors = ini::parse(newLayer->text, [&](const ini::Entry& entry) {
+			if (ini::iequals(entry.section, "DLLPathOverrides"))
+				newLayer->values.push_back({ nullptr, entry.key, ini::trim_quotes(entry.value) });
+			else if (ini::iequals(entry.section, "DLSSTweaks") && ini::iequals(entry.key, "BaseINI"))
+				newLayer->baseIni = ini::trim_quotes(entry.value);
+			else if (const SettingDef* def = FindSetting(entry.section, entry.key))
+				newLayer->values.push_back({ def, entry.key, entry.value });
+			// Anything outside of the schema (comments that look like keys, etc) is ignored
+			return true;
+		});
+
+		if (numErrors)
+			spdlog::debug("{}: skipped {} malformed line(s)", canonicalPath.filename().string(), numErrors);
+
+		spdlog::info("Config read from {}", canonicalPath.string());
+
+		layer = std::move(newLayer);
+		out = layer.get();
+		return Result::Ok;
 	}
 
-	// [DLSS]
-	forceDLAA = ini.Get<bool>("DLSS", "ForceDLAA", std::move(forceDLAA));
-	overrideAutoExposure = ini.Get<int>("DLSS", "OverrideAutoExposure", std::move(overrideAutoExposure));
-	overrideAlphaUpscaling = ini.Get<int>("DLSS", "OverrideAlphaUpscaling", std::move(overrideAlphaUpscaling));
+private:
+	std::map<std::filesystem::path, std::unique_ptr<IniLayer>> m_layers;
+	std::map<std::filesystem::path, std::filesystem::path> m_canonical;
+	uint32_t m_generation = 0;
+};
+
+IniLayerCache layerCache;
+ProfileDb profileDb;
+std::mutex readMutex; // INI watcher & NGX init hooks can both trigger reads
 
-	std::string sharpeningString = utility::ini_get_string_safe(ini, "DLSS", "OverrideSharpening", std::move(overrideSharpeningString));
-	if (!sharpeningString.length() || !_stricmp(sharpeningString.c_str(), "default") ||
-		!_stricmp(sharpeningString.c_str(), "ignore") || !_stricmp(sharpeningString.c_str(), "ignored"))
+std::atomic<std::shared_ptr<const UserSettings>> publishedSettings;
+
+// Profile keys matching the current game, in the order they get applied (most specific last)
+std::vector<std::string> MatchingProfiles(const std::string& exeName)
+{
+	std::vector<std::string> keys;
+	if (!exeName.empty())
+		keys.push_back(ProfileDb::make_key(ProfileDb::Kind::Exe, exeName));
 	{
-		overrideSharpening.reset();
-		overrideSharpeningString = sharpeningString;
-		overrideSharpeningForceDisable = false;
+		std::scoped_lock lock(dlss.idMutex);
+		if (!dlss.projectId.empty())
+			keys.push_back(ProfileDb::make_key(ProfileDb::Kind::ProjectId, dlss.projectId));
+		if (dlss.appId != 0)
+			keys.push_back(ProfileDb::make_key(ProfileDb::Kind::AppId, std::to_string(dlss.appId)));
 	}
-	else if (!_stricmp(sharpeningString.c_str(), "disable") || !_stricmp(sharpeningString.c_str(), "disabled"))
+
+	std::erase_if(keys, [](const std::string& key) { return !profileDb.find(key); });
+	return keys;
+}
+
+void RecordStamp(std::vector<std::pair<std::filesystem::path, utility::FileStamp>>& stamps, const std::filesystem::path& path, const utility::FileStamp& stamp)
+{
+	if (std::find_if(stamps.begin(), stamps.end(), [&path](const auto& entry) { return entry.first == path; }) == stamps.end())
+		stamps.emplace_back(path, stamp);
+}
+};
+
+std::shared_ptr<const UserSettings> current_settings()
+{
+	if (auto snapshot = publishedSettings.load(std::memory_order_acquire))
+		return snapshot;
+
+	// Nothing published yet, defaults are what settings would hold at this point anyway
+	static const auto defaults = std::make_shared<const UserSettings>();
+	return defaults;
+}
+
+void UserSettings::publish() const
+{
+	// Hooks might still be using the previous snapshot, they keep it alive through their own reference until they're done
+	publishedSettings.store(std::make_shared<const UserSettings>(*this), std::memory_order_release);
+}
+
+bool UserSettings::read(const std::vector<std::filesystem::path>& rootInis)
+{
+	std::scoped_lock lock(readMutex);
+	return read_locked(rootInis);
+}
+
+bool UserSettings::reload()
+{
+	std::scoped_lock lock(readMutex);
+	const auto roots = rootInis; // read replaces rootInis
+	return read_locked(roots);
+}
+
+bool UserSettings::read_locked(const std::vector<std::filesystem::path>& rootInis)
+{
+	layerCache.begin_reload();
+
+	// Build up the new settings from defaults, so that values removed from an INI fall back to whatever is beneath them
+	UserSettings next = *this;
+	next.reset_to_defaults();
+	next.iniChain.clear();
+	next.missingInis.clear();
+	next.iniStamps.clear();
+	next.rootInis = rootInis;
+
+	for (const auto& root : rootInis)
 	{
-		*overrideSharpening = 0;
-		overrideSharpeningString = sharpeningString;
-		overrideSharpeningForceDisable = true;
+		std::vector<const IniLayer*> stack;
+		if (!next.merge_ini(root, stack))
+			return false;
 	}
-	else
+
+	// Profiles go on top of the root INIs, since the INI next to the game is usually just the default one with every key filled in
+	next.appliedProfiles.clear();
+	if (!profilesPath.empty())
 	{
-		try
+		if (!profileDb.refresh(profilesPath))
 		{
-			float sharpeningValue = utility::stof_nolocale(sharpeningString, true);
-			overrideSharpening = std::clamp(sharpeningValue, -1.0f, 1.0f);
-			overrideSharpeningString = sharpeningString;
-			overrideSharpeningForceDisable = false;
+			spdlog::error("Failed to read profiles from {}", profilesPath.string());
+			return false;
 		}
-		catch (const std::exception&)
+
+		if (profileDb.exists())
+			next.iniChain.push_back(profilesPath);
+		RecordStamp(next.iniStamps, profilesPath, profileDb.stamp());
+
+		next.appliedProfiles = MatchingProfiles(profileExeName);
+		for (const auto& key : next.appliedProfiles)
 		{
-			spdlog::error("OverrideSharpening: invalid value \"{}\" specified, leaving value as {}", sharpeningString, overrideSharpeningString);
+			next.apply_layer(*profileDb.find(key));
+			spdlog::info("Profiles: applied [{}]", key);
 		}
 	}
 
-	overrideDlssHud = ini.Get<int>("DLSS", "OverrideDlssHud", std::move(overrideDlssHud));
-	disableDevWatermark = ini.Get<bool>("DLSS", "DisableDevWatermark", std::move(disableDevWatermark));
-	verboseLogging = ini.Get<bool>("DLSS", "VerboseLogging", std::move(verboseLogging));
+	commit(std::move(next));
+	return true;
+}
 
-	std::set<std::string> keys;
-	// [DLLPathOverrides]
-	try
+void UserSettings::set_values(const std::vector<std::pair<const SettingDef*, std::string_view>>& values)
+{
+	std::scoped_lock lock(readMutex);
+
+	// Applied to a copy & swapped in together, so hooks never see only some of the values
+	UserSettings next = *this;
+	for (const auto& [def, value] : values)
+		next.apply_value(*def, value);
+
+	commit(std::move(next));
+}
+
+void UserSettings::commit(UserSettings&& next)
+{
+	// Only fields that ended up with a different value count as changed
+	const uint64_t changed = diff(next);
+	const bool dllOverridesChanged = dllPathOverrides != next.dllPathOverrides;
+	const uint64_t pendingChanges = changedFields;
+	const bool pendingDllOverrides = changedDllOverrides;
+
+	*this = std::move(next);
+	changedFields = pendingChanges | changed;
+	changedDllOverrides = pendingDllOverrides || dllOverridesChanged;
+	publish();
+
+	// Let our module hooks/patches know about any changed settings
+	dispatch_changes();
+}
+
+bool UserSettings::reapply_profiles()
+{
+	// Held through the re-read too, so nothing else can change settings between the check & the read
+	std::scoped_lock lock(readMutex);
+	if (profilesPath.empty())
+		return false;
+
+	// Might not have been read yet if settings came from the config cache, refresh is only a stamp check otherwise
+	if (!profileDb.refresh(profilesPath) || !profileDb.exists() || MatchingProfiles(profileExeName) == appliedProfiles)
+		return false;
+
+	// App ID/project ID has picked up a different profile, do a full read so that values from the old one get undone
+	const auto roots = rootInis; // read replaces rootInis
+	return read_locked(roots);
+}
+
+bool UserSettings::merge_ini(const std::filesystem::path& iniPath, std::vector<const IniLayer*>& stack)
+{
+	const auto& canonicalPath = layerCache.canonicalize(iniPath);
+
+	// Anything already on the stack is an INI that's (indirectly) including this one
+	for (size_t i = 0; i < stack.size(); i++)
+	{
+		if (stack[i]->path != canonicalPath)
+			continue;
+
+		std::string cycle;
+		for (size_t j = i; j < stack.size(); j++)
+			cycle += stack[j]->path.filename().string() + " -> ";
+		cycle += canonicalPath.filename().string();
+
+		spdlog::error("BaseINI: include cycle detected ({}), skipping", cycle);
+		return true;
+	}
+
+	const IniLayer* layer = nullptr;
+	const auto result = layerCache.load(canonicalPath, layer);
+
+	// Stamps from the read itself, so the config cache can't end up vouching for a newer version of the file than the one parsed
+	// Roots are recorded under the path they were given as too, since that's how the cache refers to them
+	if (result != IniLayerCache::Result::Failed)
+	{
+		const auto stamp = result == IniLayerCache::Result::Ok ? layer->stamp : utility::FileStamp{};
+		RecordStamp(iniStamps, canonicalPath, stamp);
+		if (stack.empty())
+			RecordStamp(iniStamps, iniPath, stamp);
+	}
+
+	switch (result)
 	{
-		keys = ini.Keys("DLLPathOverrides");
+	case IniLayerCache::Result::Missing:
+		if (!stack.empty())
+		{
+			spdlog::warn("BaseINI: {} doesn't exist, skipping", iniPath.string());
+			if (std::find(missingInis.begin(), missingInis.end(), canonicalPath) == missingInis.end())
+				missingInis.push_back(canonicalPath);
+		}
+		return true;
+	case IniLayerCache::Result::Failed:
+		spdlog::error("Failed to read config from {}", canonicalPath.string());
+		return false;
+	default:
+		break;
 	}
-	catch (const std::runtime_error&)
+
+	// [DLSSTweaks]
+
+	// BaseINI: specifies an INI file which will be read in before the rest of the INI
+	// acting as a sort of global config file if the path has been set up
+	if (!layer->baseIni.empty())
 	{
-		// No [DLLPathOverrides] section, or section is empty, ignore for now
-		keys.clear();
+		const auto baseIni = std::filesystem::path(std::u8string_view((const char8_t*)layer->baseIni.data(), layer->baseIni.size()));
+
+		stack.push_back(layer);
+		const bool success = merge_ini(baseIni, stack);
+		stack.pop_back();
+
+		if (!success)
+			return false;
 	}
 
-	for (auto& key : keys)
+	apply_layer(*layer);
+
+	if (std::find(iniChain.begin(), iniChain.end(), canonicalPath) == iniChain.end())
+		iniChain.push_back(canonicalPath);
+
+	return true;
+}
+
+void UserSettings::apply_layer(const IniLayer& layer)
+{
+	// DLSSQualityLevels values are only used if Enable is set, which might come after them in the file
+	// so hold onto them until the whole INI has been applied
+	std::array<const IniLayer::Value*, SettingsSchema.size()> pendingQualities{};
+	size_t numPendingQualities = 0;
+
+	for (const auto& value : layer.values)
 	{
-		auto dllFileName = key;
-		if (!std::filesystem::path(dllFileName).has_extension())
-			dllFileName += ".dll";
+		if (!value.def)
+		{
+			read_dll_override(value.key, value.value);
+			continue;
+		}
 
-		auto path = utility::ini_get_string_safe(ini, "DLLPathOverrides", key, "");
-		if (!path.empty() && !utility::exists_safe(path)) // empty path is allowed so that user can clear the override in local INIs
+		if (value.def->type != SettingType::QualityLevel)
 		{
-			spdlog::warn("DLLPathOverrides: override for {} skipped as path {} doesn't exist", key, path);
+			apply_value(*value.def, value.value);
 			continue;
 		}
 
-		settings.dllPathOverrides[dllFileName] = path;
+		// Later values for the same level replace earlier ones, same as a map-based INI reader would
+		size_t idx = 0;
+		while (idx < numPendingQualities && pendingQualities[idx]->def != value.def)
+			idx++;
+		if (idx == numPendingQualities)
+			numPendingQualities++;
+		pendingQualities[idx] = &value;
 	}
 
 	// [DLSSQualityLevels]
-	overrideQualityLevels = ini.Get<bool>("DLSSQualityLevels", "Enable", std::move(overrideQualityLevels));
 	if (overrideQualityLevels)
+		for (size_t i = 0; i < numPendingQualities; i++)
+			apply_value(*pendingQualities[i]->def, pendingQualities[i]->value);
+}
+
+uint64_t UserSettings::diff(const UserSettings& other) const
+{
+	uint64_t changed = 0;
+	for (const auto& def : SettingsSchema)
 	{
-		for(auto& kvp : settings.qualities)
+		bool differs = false;
+		switch (def.type)
 		{
-			auto& quality = kvp.second;
+		case SettingType::Bool:
+			differs = this->*def.boolField != other.*def.boolField;
+			break;
+		case SettingType::Int:
+		case SettingType::TriState:
+			differs = this->*def.intField != other.*def.intField;
+			break;
+		case SettingType::Sharpening:
+			differs = overrideSharpening != other.overrideSharpening || overrideSharpeningForceDisable != other.overrideSharpeningForceDisable;
+			break;
+		case SettingType::QualityLevel:
+		{
+			const auto& a = qualities.at(def.level);
+			const auto& b = other.qualities.at(def.level);
+			differs = a.scalingRatio != b.scalingRatio || a.resolution != b.resolution;
+			break;
+		}
+		case SettingType::Preset:
+			differs = qualities.at(def.level).preset != other.qualities.at(def.level).preset;
+			break;
+		}
 
-			auto value = utility::ini_get_string_safe(ini, "DLSSQualityLevels", quality.name, std::move(quality.lastUserValue));
+		if (differs)
+			changed |= 1ull << SettingIndex(def);
+	}
+	return changed;
+}
 
-			// Try parsing users string as a resolution
-			const auto res = utility::ParseResolution(value);
-			if (utility::ValidResolution(res))
-			{
-				quality.resolution = res;
-				quality.lastUserValue = value;
-				continue;
-			}
-			 
-			// Not a resolution, try parsing as float
-			try
-			{
-				float floatValue = utility::stof_nolocale(value, true);
-				quality.scalingRatio = floatValue;
-				quality.lastUserValue = value;
-			}
-			catch (const std::exception&)
-			{
-				spdlog::error(R"(DLSSQualityLevels: level "{}" has invalid value "{}" specified, leaving value as {})", quality.name, value, quality.scalingRatio);
-				continue;
-			}
+bool UserSettings::read_sharpening(std::string_view sharpeningString)
+{
+	const auto prevSharpening = overrideSharpening;
+	const bool prevForceDisable = overrideSharpeningForceDisable;
 
-			// Clamp value between 0.0 - 1.0
-			quality.scalingRatio = std::clamp(quality.scalingRatio, DLSS_MinScale, DLSS_MaxScale);
-		}
+	SharpeningMode mode;
+	float sharpeningValue = 0.f;
+	if (!parse_sharpening(sharpeningString, mode, sharpeningValue))
+	{
+		spdlog::error("OverrideSharpening: invalid value \"{}\" specified, leaving value as {}", sharpeningString, overrideSharpeningString);
+		return false;
 	}
 
-	// [DLSSPresets]
-	for (auto& kvp : qualities)
+	switch (mode)
 	{
-		kvp.second.preset = DLSS_PresetNameToEnum(utility::ini_get_string_safe(ini, "DLSSPresets", kvp.second.name, DLSS_PresetEnumToName(kvp.second.preset)));
+	case SharpeningMode::Ignore:
+		overrideSharpening.reset();
+		break;
+	case SharpeningMode::Disable:
+		overrideSharpening = 0.f;
+		break;
+	case SharpeningMode::Value:
+		overrideSharpening = sharpeningValue;
+		break;
 	}
+	overrideSharpeningString = sharpeningString;
+	overrideSharpeningForceDisable = mode == SharpeningMode::Disable;
 
-	// [Compatibility]
-	resolutionOffset = ini.Get<int>("Compatibility", "ResolutionOffset", std::move(resolutionOffset));
-	dynamicResolutionOverride = ini.Get<bool>("Compatibility", "DynamicResolutionOverride", std::move(dynamicResolutionOverride));
-	dynamicResolutionMinOffset = ini.Get<int>("Compatibility", "DynamicResolutionMinOffset", std::move(dynamicResolutionMinOffset));
-	disableIniMonitoring = ini.Get<bool>("Compatibility", "DisableIniMonitoring", std::move(disableIniMonitoring));
-	overrideAppId = ini.Get<bool>("Compatibility", "OverrideAppId", std::move(overrideAppId));
-
-	auto log_level = verboseLogging ? spdlog::level::debug : spdlog::level::info;
-#ifdef _DEBUG
-	log_level = spdlog::level::debug;
-#endif
-	if (spdlog::default_logger())
-		spdlog::default_logger()->set_level(log_level);
-	spdlog::set_level(log_level);
-
-	// Let our module hooks/patches know about new settings if needed
-	nvngx_dlssg::settings_changed();
-
-	return true;
+	return overrideSharpening != prevSharpening || overrideSharpeningForceDisable != prevForceDisable;
 }
 
-void UserSettings::watch_for_changes(const std::filesystem::path& iniPath)
+bool UserSettings::read_quality_level(QualityLevel& quality, std::string_view value)
 {
-	const std::wstring iniFileName = iniPath.filename().wstring();
-	const std::wstring iniFolder = iniPath.parent_path().wstring();
-	HANDLE file = CreateFileW(iniFolder.c_str(),
-		FILE_LIST_DIRECTORY,
-		FILE_SHARE_WRITE | FILE_SHARE_READ | FILE_SHARE_DELETE,
-		NULL,
-		OPEN_EXISTING,
-		FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
-		NULL);
+	const auto prevResolution = quality.resolution;
+	const float prevRatio = quality.scalingRatio;
 
-	if (!file)
+	// Parsed as a resolution first, then as a scaling ratio (clamped between 0.0 - 1.0)
+	std::pair<int, int> resolution;
+	float scalingRatio = quality.scalingRatio;
+	if (!parse_quality_level(value, resolution, scalingRatio))
 	{
-		DWORD err = GetLastError();
-		spdlog::error("INI monitoring: CreateFileW \"{}\" failed with error code {}", iniPath.parent_path().string(), err);
-		return;
+		spdlog::error(R"(DLSSQualityLevels: level "{}" has invalid value "{}" specified, leaving value as {})", quality.name, value, quality.scalingRatio);
+		return false;
 	}
 
-	OVERLAPPED overlapped;
-	overlapped.hEvent = CreateEvent(NULL, FALSE, 0, NULL);
-	if (!overlapped.hEvent)
+	if (utility::ValidResolution(resolution))
 	{
-		DWORD err = GetLastError();
-		spdlog::error("INI monitoring: CreateEvent failed with error code {}", err);
-		CloseHandle(file);
-		return;
+		quality.resolution = resolution;
+		return quality.resolution != prevResolution;
 	}
 
-	uint8_t change_buf[1024];
-	BOOL success = ReadDirectoryChangesW(
-		file, change_buf, 1024, TRUE,
-		FILE_NOTIFY_CHANGE_FILE_NAME |
-		FILE_NOTIFY_CHANGE_DIR_NAME |
-		FILE_NOTIFY_CHANGE_LAST_WRITE,
-		NULL, &overlapped, NULL);
+	quality.scalingRatio = scalingRatio;
+	quality.resolution = { 0,0 }; // ratio replaces any resolution set previously
 
-	if (!success)
+	return quality.scalingRatio != prevRatio || quality.resolution != prevResolution;
+}
+
+void UserSettings::read_dll_override(std::string_view dllName, std::string_view pathValue)
+{
+	const auto path = std::filesystem::path(std::u8string_view((const char8_t*)pathValue.data(), pathValue.size()));
+	if (!path.empty() && !utility::exists_safe(path)) // empty path is allowed so that user can clear the override in local INIs
 	{
-		DWORD err = GetLastError();
-		spdlog::error("INI monitoring: ReadDirectoryChangesW failed with error code {}", err);
+		spdlog::warn("DLLPathOverrides: override for {} skipped as path {} doesn't exist", dllName, pathValue);
 		return;
 	}
 
-	spdlog::info("INI monitoring: watching for INI updates...");
+	std::string dllFileName = std::string(dllName);
+	if (!std::filesystem::path(dllFileName).has_extension())
+		dllFileName += ".dll";
 
-	while (success)
+	auto& existing = dllPathOverrides[dllFileName];
+	if (existing != path)
 	{
-		DWORD result = WaitForSingleObject(overlapped.hEvent, INFINITE);
-		if (result == WAIT_OBJECT_0)
-		{
-			DWORD bytes_transferred;
-			GetOverlappedResult(file, &overlapped, &bytes_transferred, FALSE);
-
-			auto* evt = reinterpret_cast<FILE_NOTIFY_INFORMATION*>(change_buf);
-
-			for (;;)
-			{
-				if (evt->Action == FILE_ACTION_MODIFIED)
-				{
-					// evt->FileName isn't null-terminated, so construct wstring for it based on FileNameLength
-					std::wstring name = std::wstring(evt->FileName, evt->FileNameLength / sizeof(WCHAR));
-					if (!_wcsicmp(name.c_str(), iniFileName.c_str()))
-					{
-						// INI read might fail if it's still being updated by a text editor etc
-						// so try attempting a few times, Sleep(1000) between attempts should hopefully let us read it fine
-						int attempts = 3;
-						while (attempts--)
-						{
-							if (read(iniPath))
-							{
-								spdlog::info("Config updated from {}", iniPath.string());
-								break;
-							}
-							Sleep(1000);
-						}
-					}
-				}
-
-				// Any more events to handle?
-				if (evt->NextEntryOffset)
-					*(uint8_t**)&evt += evt->NextEntryOffset;
-				else
-					break;
-			}
-
-			// Queue the next event
-			success = ReadDirectoryChangesW(
-				file, change_buf, 1024, TRUE,
-				FILE_NOTIFY_CHANGE_FILE_NAME |
-				FILE_NOTIFY_CHANGE_DIR_NAME |
-				FILE_NOTIFY_CHANGE_LAST_WRITE,
-				NULL, &overlapped, NULL);
-		}
+		existing = path;
+		changedDllOverrides = true;
 	}
-
-	CloseHandle(file);
 }
 
 void DlssNvidiaPresetOverrides::zero_customized_values()
@@ -364,9 +865,11 @@ void DlssNvidiaPresetOverrides::zero_customized_values()
 	}
 
 	// Then zero out NV-provided override if user has set their own override for that level
-	overrideDLAA = settings.qualities[NVSDK_NGX_PerfQuality_Value_DLAA].preset ? 0 : dlss.nvidiaOverrides->overrideDLAA;
-	overrideQuality = settings.qualities[NVSDK_NGX_PerfQuality_Value_MaxQuality].preset ? 0 : dlss.nvidiaOverrides->overrideQuality;
-	overrideBalanced = settings.qualities[NVSDK_NGX_PerfQuality_Value_Balanced].preset ? 0 : dlss.nvidiaOverrides->overrideBalanced;
-	overridePerformance = settings.qualities[NVSDK_NGX_PerfQuality_Value_MaxPerf].preset ? 0 : dlss.nvidiaOverrides->overridePerformance;
-	overrideUltraPerformance = settings.qualities[NVSDK_NGX_PerfQuality_Value_UltraPerformance].preset ? 0 : dlss.nvidiaOverrides->overrideUltraPerformance;
+	const auto current = current_settings();
+	const auto& qualities = current->qualities;
+	overrideDLAA = qualities[NVSDK_NGX_PerfQuality_Value_DLAA].preset ? 0 : dlss.nvidiaOverrides->overrideDLAA;
+	overrideQuality = qualities[NVSDK_NGX_PerfQuality_Value_MaxQuality].preset ? 0 : dlss.nvidiaOverrides->overrideQuality;
+	overrideBalanced = qualities[NVSDK_NGX_PerfQuality_Value_Balanced].preset ? 0 : dlss.nvidiaOverrides->overrideBalanced;
+	overridePerformance = qualities[NVSDK_NGX_PerfQuality_Value_MaxPerf].preset ? 0 : dlss.nvidiaOverrides->overridePerformance;
+	overrideUltraPerformance = qualities[NVSDK_NGX_PerfQuality_Value_UltraPerformance].preset ? 0 : dlss.nvidiaOverrides->overrideUltraPerformance;
 }
@@ -4,151 +4,173 @@
 #include <winternl.h>
 #include <tchar.h>
 #include <cstdint>
+#include <algorithm>
 
 #include "DLSSTweaks.hpp"
+#include "PeImage.hpp"
 
 namespace utility
 {
 
-std::string DLSS_PresetEnumToName(unsigned int val)
+FileStamp GetFileStamp(const std::filesystem::path& path)
 {
-	if (val <= NVSDK_NGX_DLSS_Hint_Render_Preset_Default || val > NVSDK_NGX_DLSS_Hint_Render_Preset_G)
-		return "Default";
-	const int charVal = int(val) - 1 + 'A';
-	std::string ret(1, charVal);
-	return ret;
+	FileStamp stamp;
+	WIN32_FILE_ATTRIBUTE_DATA data{};
+	if (!GetFileAttributesExW(path.c_str(), GetFileExInfoStandard, &data))
+		return stamp;
+
+	stamp.exists = true;
+	stamp.size = (uint64_t(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+	stamp.mtime = (uint64_t(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+	return stamp;
 }
 
-unsigned int DLSS_PresetNameToEnum(const std::string& val)
+BOOL HookIAT(HMODULE callerModule, char const* targetModule, const void* targetFunction, void* detourFunction)
 {
-	if (!_stricmp(val.c_str(), "Default"))
-		return NVSDK_NGX_DLSS_Hint_Render_Preset_Default;
-	if (!_stricmp(val.c_str(), "A"))
-		return NVSDK_NGX_DLSS_Hint_Render_Preset_A;
-	if (!_stricmp(val.c_str(), "B"))
-		return NVSDK_NGX_DLSS_Hint_Render_Preset_B;
-	if (!_stricmp(val.c_str(), "C"))
-		return NVSDK_NGX_DLSS_Hint_Render_Preset_C;
-	if (!_stricmp(val.c_str(), "D"))
-		return NVSDK_NGX_DLSS_Hint_Render_Preset_D;
-	if (!_stricmp(val.c_str(), "E"))
-		return NVSDK_NGX_DLSS_Hint_Render_Preset_E;
-	if (!_stricmp(val.c_str(), "F"))
-		return NVSDK_NGX_DLSS_Hint_Render_Preset_F;
-	if (!_stricmp(val.c_str(), "G"))
-		return NVSDK_NGX_DLSS_Hint_Render_Preset_G;
-
-	return NVSDK_NGX_DLSS_Hint_Render_Preset_Default;
-}
+	pe::Image image;
+	if (!image.parse_mapped(callerModule))
+		return FALSE;
 
-std::pair<int, int> ParseResolution(std::string_view val)
-{
-	std::pair result = { 0,0 };
-	if (val.size() < 3) // minimum is "0x0"
-		return result;
+	const uint32_t thunkRva = image.find_import_by_value(targetModule, uint64_t(uintptr_t(targetFunction)));
+	if (!thunkRva)
+		return FALSE;
+
+	void** thunk = (void**)((uint8_t*)callerModule + thunkRva);
 
-	const size_t separator = val.find('x');
-	if (separator == std::string::npos || val.size() <= separator + 1)
-		return result;
+	DWORD oldState;
+	if (!VirtualProtect(thunk, sizeof(void*), PAGE_READWRITE, &oldState))
+		return FALSE;
 
-	const auto width_str = std::string(val.substr(0, separator));
-	const auto height_str = std::string(val.substr(separator + 1));
-	result.first = std::stoi(width_str);
-	result.second = std::stoi(height_str);
+	*thunk = detourFunction;
 
-	return result;
+	VirtualProtect(thunk, sizeof(void*), oldState, &oldState);
+
+	return TRUE;
 }
 
-std::string trim_quotes(const std::string& str)
+FARPROC GetExport(HMODULE module, const pe::Image& image, const char* name)
 {
-	// Find the first non-whitespace (and non-quote) character
-	const auto start = std::find_if_not(str.begin(), str.end(), [](int c) {
-		return std::isspace(c) || c == '"' || c == '\'';
-		});
-
-	// Find the last non-whitespace (and non-quote) character
-	const auto end = std::find_if_not(str.rbegin(), str.rend(), [](int c) {
-		return std::isspace(c) || c == '"' || c == '\'';
-		});
-
-	// Convert iterators to indices
-	const auto first = std::distance(str.begin(), start);
-	const auto last = std::distance(str.begin(), end.base());
-
-	// Return the trimmed substring
-	return str.substr(first, last - first);
+	const auto exp = image.find_export(name);
+	if (!exp)
+		return nullptr;
+
+	// Forwarded exports are a "module.function" string, leave following those to the loader
+	if (exp.forwarded)
+		return GetProcAddress(module, name);
+
+	return (FARPROC)((uint8_t*)module + exp.rva);
 }
 
-// Strips any improperly quoted string & any useless whitespace
-std::string ini_get_string_safe(inih::INIReader& ini, const std::string& section, const std::string& name, std::string&& default_v)
+};
+
+void PatchSet::add(void* address, const void* data, size_t size)
 {
-	const auto ret = ini.Get<std::string>(section, name, std::move(default_v));
-	return trim_quotes(ret);
+	if (!address || !data || !size)
+		return;
+
+	auto* dest = (uint8_t*)address;
+	const size_t offset = m_patchedBytes.size();
+
+	m_patchedBytes.insert(m_patchedBytes.end(), (const uint8_t*)data, (const uint8_t*)data + size);
+	m_originalBytes.insert(m_originalBytes.end(), dest, dest + size);
+
+	if (!m_patches.empty() && m_patches.back().address > dest)
+		m_sorted = false;
+
+	m_patches.push_back({ dest, size, offset });
 }
 
-// Converts string to float using std::from_chars (which uses "C" locale), and also converts comma formatted numbers to use period
-// (this way we don't need to bother with std::setlocale shenanigans, which may have conflicts with the hooked app)
-float stof_nolocale(std::string_view s, bool strict)
+bool PatchSet::apply()
 {
-	std::string conv = std::string(s);
+	if (!write(true))
+		return false;
 
-	// In case user uses commas for decimals, switch out first comma found to a period instead
-	if (const auto comma_pos = conv.find(','); comma_pos != std::string::npos)
-		conv[comma_pos] = '.';
+	m_applied = true;
+	return true;
+}
 
-	if (strict)
-	{
-		// Disallow any characters other than numeric / period / whitespace
-		auto charIsNonNumeric = [](char c) { return !std::isdigit(c) && c != '-' && c != '.' && c != ' ' && c != '\t'; };
-		if (std::ranges::any_of(conv, charIsNonNumeric))
-			throw std::invalid_argument{ "invalid_argument" };
-	}
+bool PatchSet::revert()
+{
+	if (!write(false))
+		return false;
 
-	float result{};
-	auto [ptr, ec] { std::from_chars(conv.data(), conv.data() + conv.size(), result) };
-	if (ec == std::errc::invalid_argument)
-		throw std::invalid_argument{ "invalid_argument" };
-	if (ec == std::errc::result_out_of_range)
-		throw std::out_of_range{ "out_of_range" };
+	m_applied = false;
+	return true;
+}
 
-	return result;
+void PatchSet::clear()
+{
+	m_patches.clear();
+	m_patchedBytes.clear();
+	m_originalBytes.clear();
+	m_applied = false;
+	m_sorted = true;
 }
 
-BOOL HookIAT(HMODULE callerModule, char const* targetModule, const void* targetFunction, void* detourFunction)
+bool PatchSet::write(bool patched)
 {
-	auto* base = (uint8_t*)callerModule;
-	const auto* dos_header = (IMAGE_DOS_HEADER*)base;
-	const auto nt_headers = (IMAGE_NT_HEADERS*)(base + dos_header->e_lfanew);
-	const auto* imports = (IMAGE_IMPORT_DESCRIPTOR*)(base + nt_headers->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_IMPORT].VirtualAddress);
+	if (m_patches.empty())
+		return true;
 
-	for (int i = 0; imports[i].Characteristics; i++)
+	if (!m_sorted)
 	{
-		const char* name = (const char*)(base + imports[i].Name);
-		if (lstrcmpiA(name, targetModule) != 0)
-			continue;
+		std::sort(m_patches.begin(), m_patches.end(), [](const Patch& a, const Patch& b) { return a.address < b.address; });
+		m_sorted = true;
+	}
+
+	static const uintptr_t pageSize = [] {
+		SYSTEM_INFO info{};
+		GetSystemInfo(&info);
+		return uintptr_t(info.dwPageSize ? info.dwPageSize : 0x1000);
+	}();
+
+	auto pageStart = [](uintptr_t addr) { return addr & ~(pageSize - 1); };
+	auto pageEnd = [](uintptr_t addr) { return (addr + pageSize - 1) & ~(pageSize - 1); };
 
-		void** thunk = (void**)(base + imports[i].FirstThunk);
+	const auto& bytes = patched ? m_patchedBytes : m_originalBytes;
 
-		for (; *thunk; thunk++)
+	bool success = true;
+	size_t i = 0;
+	while (i < m_patches.size())
+	{
+		const uintptr_t runStart = pageStart(uintptr_t(m_patches[i].address));
+		uintptr_t runEnd = pageEnd(uintptr_t(m_patches[i].address) + m_patches[i].size);
+
+		// Merge any following patches that land inside the same VirtualQuery region (which all share one protection)
+		// so that restoring the old protection afterward is valid for the whole run
+		uintptr_t regionEnd = runEnd;
+		MEMORY_BASIC_INFORMATION mbi{};
+		if (VirtualQuery((LPCVOID)runStart, &mbi, sizeof(mbi)))
+			regionEnd = std::max(runEnd, uintptr_t(mbi.BaseAddress) + mbi.RegionSize);
+
+		size_t j = i + 1;
+		while (j < m_patches.size())
 		{
-			const void* import = *thunk;
+			const uintptr_t nextStart = uintptr_t(m_patches[j].address);
+			const uintptr_t nextEnd = pageEnd(nextStart + m_patches[j].size);
+			if (nextEnd > regionEnd)
+				break;
 
-			if (import != targetFunction)
-				continue;
+			runEnd = std::max(runEnd, nextEnd);
+			j++;
+		}
 
-			DWORD oldState;
-			if (!VirtualProtect(thunk, sizeof(void*), PAGE_READWRITE, &oldState))
-				return FALSE;
+		DWORD oldProtect = 0;
+		if (!VirtualProtect((LPVOID)runStart, runEnd - runStart, PAGE_EXECUTE_READWRITE, &oldProtect))
+		{
+			success = false;
+			i = j;
+			continue;
+		}
 
-			*thunk = detourFunction;
+		for (size_t k = i; k < j; k++)
+			memcpy(m_patches[k].address, bytes.data() + m_patches[k].offset, m_patches[k].size);
 
-			VirtualProtect(thunk, sizeof(void*), oldState, &oldState);
+		VirtualProtect((LPVOID)runStart, runEnd - runStart, oldProtect, &oldProtect);
+		FlushInstructionCache(GetCurrentProcess(), (LPCVOID)runStart, runEnd - runStart);
 
-			return TRUE;
-		}
+		i = j;
 	}
 
-	return FALSE;
+	return success;
 }
-
-};
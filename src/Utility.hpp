@@ -1,20 +1,18 @@
 #pragma once
+#include <cstdint>
 #include <filesystem>
-#include <ini.h>
+#include <string_view>
+#include <vector>
 
-namespace utility
-{
-std::string DLSS_PresetEnumToName(unsigned int val);
-unsigned int DLSS_PresetNameToEnum(const std::string& val);
-std::pair<int, int> ParseResolution(std::string_view val);
-inline bool ValidResolution(const std::pair<int, int> val)
-{
-	return val.first > 0 && val.second > 0;
-}
+#include "UtilityParse.hpp"
 
-std::string ini_get_string_safe(inih::INIReader& ini, const std::string& section, const std::string& name, std::string&& default_v);
-float stof_nolocale(std::string_view s, bool strict = false);
+namespace pe
+{
+class Image;
+};
 
+namespace utility
+{
 // exists can cause exception under certain apps (UWP?), grr...
 inline bool exists_safe(const std::filesystem::path& path)
 {
@@ -30,8 +28,22 @@ inline bool exists_safe(const std::filesystem::path& path)
 	return exists;
 }
 
+// Size & last-write time of a file, used to check if a file has changed without needing to read it
+struct FileStamp
+{
+	bool exists = false;
+	uint64_t size = 0;
+	uint64_t mtime = 0;
+
+	bool operator==(const FileStamp&) const = default;
+};
+FileStamp GetFileStamp(const std::filesystem::path& path);
+
 BOOL HookIAT(HMODULE callerModule, char const* targetModule, const void* targetFunction, void* detourFunction);
 
+// Looks up an export using an already parsed image of module, instead of a separate GetProcAddress search for each one
+FARPROC GetExport(HMODULE module, const pe::Image& image, const char* name);
+
 inline void* ModuleEntryPoint(HMODULE hmod)
 {
 	const auto dos_header = (PIMAGE_DOS_HEADER)hmod;
@@ -77,6 +89,48 @@ private:
 	DWORD m_protect{};
 };
 
+// Batches up a set of small code/data writes, grouping them by page so VirtualProtect only needs to be called once per run of pages
+// The original bytes are kept alongside the patched ones, letting the whole set be reverted/reapplied later on without needing to rescan for them
+class PatchSet
+{
+public:
+	// Original bytes are read from address when the patch is added
+	void add(void* address, const void* data, size_t size);
+
+	template <typename T> void add(void* address, const T& value)
+	{
+		add(address, &value, sizeof(T));
+	}
+
+	// Writes the patched bytes into memory
+	bool apply();
+	// Writes the original bytes back
+	bool revert();
+
+	bool is_applied() const { return m_applied; }
+	bool empty() const { return m_patches.empty(); }
+	size_t size() const { return m_patches.size(); }
+
+	// Forgets all patches without touching memory (eg. if the module holding them has been unloaded)
+	void clear();
+
+private:
+	struct Patch
+	{
+		uint8_t* address;
+		size_t size;
+		size_t offset; // offset into m_patchedBytes/m_originalBytes
+	};
+
+	bool write(bool patched);
+
+	std::vector<Patch> m_patches;
+	std::vector<uint8_t> m_patchedBytes;
+	std::vector<uint8_t> m_originalBytes;
+	bool m_applied = false;
+	bool m_sorted = true;
+};
+
 #ifdef _WINTERNL_ // only include LdrRegisterDllNotificationFunc if winternl.h had been included beforehand
 // defs below from chromium: https://source.chromium.org/chromium/chromium/src/+/main:chrome/common/conflicts/module_watcher_win.cc
 
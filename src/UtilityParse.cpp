@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+#include <nvsdk_ngx_defs.h>
+
+#include "IniParser.hpp"
+#include "UtilityParse.hpp"
+
+namespace utility
+{
+std::string DLSS_PresetEnumToName(unsigned int val)
+{
+	if (val <= NVSDK_NGX_DLSS_Hint_Render_Preset_Default || val > NVSDK_NGX_DLSS_Hint_Render_Preset_G)
+		return "Default";
+	const int charVal = int(val) - 1 + 'A';
+	std::string ret(1, charVal);
+	return ret;
+}
+
+unsigned int DLSS_PresetNameToEnum(std::string_view val)
+{
+	if (val.size() == 1)
+	{
+		const char letter = ini::to_lower(val[0]);
+		if (letter >= 'a' && letter <= 'g')
+			return NVSDK_NGX_DLSS_Hint_Render_Preset_A + unsigned(letter - 'a');
+	}
+
+	return NVSDK_NGX_DLSS_Hint_Render_Preset_Default;
+}
+
+std::pair<int, int> ParseResolution(std::string_view val)
+{
+	std::pair result = { 0,0 };
+	if (val.size() < 3) // minimum is "0x0"
+		return result;
+
+	const size_t separator = val.find('x');
+	if (separator == std::string_view::npos || val.size() <= separator + 1)
+		return result;
+
+	const auto width_str = ini::trim(val.substr(0, separator));
+	const auto height_str = ini::trim(val.substr(separator + 1));
+
+	std::pair<int, int> parsed = { 0,0 };
+	auto [widthEnd, widthEc] = std::from_chars(width_str.data(), width_str.data() + width_str.size(), parsed.first);
+	auto [heightEnd, heightEc] = std::from_chars(height_str.data(), height_str.data() + height_str.size(), parsed.second);
+	if (widthEc != std::errc{} || heightEc != std::errc{})
+		return result;
+
+	return parsed;
+}
+
+// Converts string to float using std::from_chars (which uses "C" locale), and also converts comma formatted numbers to use period
+// (this way we don't need to bother with std::setlocale shenanigans, which may have conflicts with the hooked app)
+float stof_nolocale(std::string_view s, bool strict)
+{
+	// Copy into a small stack buffer so the comma can be swapped out without needing a std::string
+	char conv[64];
+	if (s.size() >= sizeof(conv))
+		throw std::invalid_argument{ "invalid_argument" };
+	std::copy(s.begin(), s.end(), conv);
+	const size_t size = s.size();
+
+	// In case user uses commas for decimals, switch out first comma found to a period instead
+	if (char* comma = std::find(conv, conv + size, ','); comma != conv + size)
+		*comma = '.';
+
+	if (strict)
+	{
+		// Disallow any characters other than numeric / period / whitespace
+		auto charIsNonNumeric = [](char c) { return !(c >= '0' && c <= '9') && c != '-' && c != '.' && c != ' ' && c != '\t'; };
+		if (std::any_of(conv, conv + size, charIsNonNumeric))
+			throw std::invalid_argument{ "invalid_argument" };
+	}
+
+	float result{};
+	auto [ptr, ec] { std::from_chars(conv, conv + size, result) };
+	if (ec == std::errc::invalid_argument)
+		throw std::invalid_argument{ "invalid_argument" };
+	if (ec == std::errc::result_out_of_range)
+		throw std::out_of_range{ "out_of_range" };
+
+	return result;
+}
+};
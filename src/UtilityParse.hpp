@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+
+// String/value parsing helpers used when reading settings
+// Kept free of any Win32/NGX dependencies so it can also be built on other platforms
+namespace utility
+{
+std::string DLSS_PresetEnumToName(unsigned int val);
+unsigned int DLSS_PresetNameToEnum(std::string_view val);
+std::pair<int, int> ParseResolution(std::string_view val);
+inline bool ValidResolution(const std::pair<int, int> val)
+{
+	return val.first > 0 && val.second > 0;
+}
+
+// 64-bit FNV-1a, cheap hash for checking if file contents/names have changed (not for anything security related)
+constexpr uint64_t fnv1a(std::string_view data, uint64_t hash = 0xcbf29ce484222325ull)
+{
+	for (const char c : data)
+	{
+		hash ^= uint8_t(c);
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+float stof_nolocale(std::string_view s, bool strict = false);
+};
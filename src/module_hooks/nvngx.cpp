@@ -2,10 +2,18 @@
 #define WIN32_NO_STATUS
 #include <Windows.h>
 #include <winternl.h>
+#include <Psapi.h>
 
-#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iterator>
+#include <tuple>
 
 #include "DLSSTweaks.hpp"
+#include "HookLogic.hpp"
+#include "Log.hpp"
+#include "PeImage.hpp"
 #include "Proxy.hpp"
 
 const char* projectIdOverride = "24480451-f00d-face-1304-0308dabad187";
@@ -57,7 +65,7 @@ void on_evaluate_feature(const NVSDK_NGX_Parameter* InParameters)
 				userBeenWarned = true;
 			}
 
-			if (settings.overrideAutoExposure > 0)
+			if (current_settings()->overrideAutoExposure > 0)
 			{
 				spdlog::warn("NVSDK_NGX_EvaluateFeature: game is using custom exposure value but OverrideAutoExposure is enabled, recommend setting to 0 or -1!");
 				userBeenWarned = true;
@@ -68,7 +76,7 @@ void on_evaluate_feature(const NVSDK_NGX_Parameter* InParameters)
 			spdlog::log(userBeenWarned ? spdlog::level::warn : spdlog::level::debug,
 				"NVSDK_NGX_EvaluateFeature: pInExposureTexture set to 0, game might not be using custom exposure value");
 
-			if (settings.overrideAutoExposure <= 0 && !(dlss.featureCreateFlags & NVSDK_NGX_DLSS_Feature_Flags_AutoExposure))
+			if (current_settings()->overrideAutoExposure <= 0 && !(dlss.featureCreateFlags & NVSDK_NGX_DLSS_Feature_Flags_AutoExposure))
 			{
 				spdlog::warn("NVSDK_NGX_EvaluateFeature: game not using custom exposure value or AutoExposure, recommend setting OverrideAutoExposure to 1!");
 				userBeenWarned = true;
@@ -81,17 +89,30 @@ void on_evaluate_feature(const NVSDK_NGX_Parameter* InParameters)
 
 void on_init_appid(unsigned long long& appId)
 {
-	dlss.appId = appId;
-	spdlog::debug("on_init_appid: 0x{:X} (0x{:X})", appId, dlss.appIdDlss());
-	if (settings.overrideAppId)
+	startup::on_ngx_init();
+	{
+		std::scoped_lock lock(dlss.idMutex);
+		dlss.appId = appId;
+		spdlog::debug("on_init_appid: 0x{:X} (0x{:X})", appId, dlss.appIdDlss());
+	}
+
+	// Re-reading INIs is too slow to do on the game thread, any profile picked up by the ID applies from the next init onwards
+	service::post([] { settings.reapply_profiles(); });
+	if (current_settings()->overrideAppId)
 		appId = appIdOverride;
 }
 
 void on_init_projectid(const char*& projectId)
 {
-	dlss.projectId = projectId;
+	startup::on_ngx_init();
+	{
+		std::scoped_lock lock(dlss.idMutex);
+		dlss.projectId = projectId;
+	}
 	spdlog::debug("on_init_projectid: {}", projectId);
-	if (settings.overrideAppId)
+
+	service::post([] { settings.reapply_profiles(); });
+	if (current_settings()->overrideAppId)
 		projectId = projectIdOverride;
 }
 
@@ -205,19 +226,54 @@ NVSDK_NGX_Result __cdecl NVSDK_NGX_VULKAN_Init_ProjectID_Ext(const char* InProje
 	return NVSDK_NGX_VULKAN_Init_ProjectID_Ext_Hook.unsafe_call<NVSDK_NGX_Result>(InProjectId, InEngineType, InEngineVersion, InApplicationDataPath, InInstance, InPD, InDevice, InGIPA, InGDPA, InSDKVersion, InFeatureInfo);
 }
 
-SafetyHookInline NVSDK_NGX_Parameter_SetF_Hook;
+HookOrigFn NVSDK_NGX_Parameter_SetF_Hook;
 void __cdecl NVSDK_NGX_Parameter_SetF(NVSDK_NGX_Parameter* InParameter, const char* InName, float InValue)
 {
 	// Sharpening override (pre-2.5.1 only)
-	if (settings.overrideSharpening.has_value() && !_stricmp(InName, NVSDK_NGX_Parameter_Sharpness))
-		InValue = *settings.overrideSharpening;
+	const auto current = current_settings();
+	if (current->overrideSharpening.has_value() && !_stricmp(InName, NVSDK_NGX_Parameter_Sharpness))
+		InValue = *current->overrideSharpening;
+
+	NVSDK_NGX_Parameter_SetF_Hook.unsafe_call(InParameter, InName, InValue);
+}
+
+// Setting names for the CreateFeature flags that can be overridden, so only the flags that actually got changed need to be logged
+struct FlagOverrideName
+{
+	int flag;
+	const char* setting;
+	const char* name;
+};
+
+constexpr FlagOverrideName FlagOverrideNames[] = {
+	{ NVSDK_NGX_DLSS_Feature_Flags_IsHDR, "OverrideHDR", "NVSDK_NGX_DLSS_Feature_Flags_IsHDR" },
+	{ NVSDK_NGX_DLSS_Feature_Flags_AutoExposure, "OverrideAutoExposure", "NVSDK_NGX_DLSS_Feature_Flags_AutoExposure" },
+	{ NVSDK_NGX_DLSS_Feature_Flags_AlphaUpscaling, "OverrideAlphaUpscaling", "NVSDK_NGX_DLSS_Feature_Flags_AlphaUpscaling" },
+	{ NVSDK_NGX_DLSS_Feature_Flags_DoSharpening, "OverrideSharpening", "NVSDK_NGX_DLSS_Feature_Flags_DoSharpening" },
+};
 
-	NVSDK_NGX_Parameter_SetF_Hook.call(InParameter, InName, InValue);
+void log_flag_overrides(int origFlags, int newFlags)
+{
+	for (const auto& flag : FlagOverrideNames)
+	{
+		const bool wasSet = (origFlags & flag.flag) != 0;
+		const bool isSet = (newFlags & flag.flag) != 0;
+		if (isSet && !wasSet)
+			spdlog::debug("{}: force enabling flag {}", flag.setting, flag.name);
+		else if (wasSet && !isSet)
+		{
+			// sharpening is the only one that was ever logged as info
+			spdlog::log(flag.flag == NVSDK_NGX_DLSS_Feature_Flags_DoSharpening ? spdlog::level::info : spdlog::level::debug,
+				"{}: force disabling flag {}", flag.setting, flag.name);
+		}
+	}
 }
 
-SafetyHookInline NVSDK_NGX_Parameter_SetI_Hook;
+HookOrigFn NVSDK_NGX_Parameter_SetI_Hook;
 void __cdecl NVSDK_NGX_Parameter_SetI(NVSDK_NGX_Parameter* InParameter, const char* InName, int InValue)
 {
+	const auto current = current_settings();
+
 	if (!_stricmp(InName, NVSDK_NGX_Parameter_DLSS_Feature_Create_Flags))
 	{
 		dlss.featureCreateFlags = InValue;
@@ -241,64 +297,16 @@ void __cdecl NVSDK_NGX_Parameter_SetI(NVSDK_NGX_Parameter* InParameter, const ch
 		if (auto remainder = dlss.featureCreateFlags & ~((lastKnownFlag << 1) - 1))
 			spdlog::debug("NVSDK_NGX_Parameter_SetI: - unknown flags: 0x{:X}", remainder);
 
-		if (settings.overrideHDR != 0)
-		{
-			if (settings.overrideHDR >= 1) // force HDR
-			{
-				spdlog::debug("OverrideHDR: force enabling flag NVSDK_NGX_DLSS_Feature_Flags_IsHDR");
-				InValue |= NVSDK_NGX_DLSS_Feature_Flags_IsHDR;
-			}
-			else if (settings.overrideHDR < 0) // force disable HDR
-			{
-				spdlog::debug("OverrideHDR: force disabling flag NVSDK_NGX_DLSS_Feature_Flags_IsHDR");
-				InValue = InValue & ~NVSDK_NGX_DLSS_Feature_Flags_IsHDR;
-			}
-		}
-
-		if (settings.overrideAutoExposure != 0)
-		{
-			if (settings.overrideAutoExposure >= 1) // force auto-exposure
-			{
-				spdlog::debug("OverrideAutoExposure: force enabling flag NVSDK_NGX_DLSS_Feature_Flags_AutoExposure");
-				InValue |= NVSDK_NGX_DLSS_Feature_Flags_AutoExposure;
-			}
-			else if (settings.overrideAutoExposure < 0) // force disable auto-exposure
-			{
-				spdlog::debug("OverrideAutoExposure: force disabling flag NVSDK_NGX_DLSS_Feature_Flags_AutoExposure");
-				InValue = InValue & ~NVSDK_NGX_DLSS_Feature_Flags_AutoExposure;
-			}
-		}
-
-		if (settings.overrideAlphaUpscaling != 0)
-		{
-			if (settings.overrideAlphaUpscaling >= 1) // force alpha-upscaling
-			{
-				spdlog::debug("OverrideAlphaUpscaling: force enabling flag NVSDK_NGX_DLSS_Feature_Flags_AlphaUpscaling");
-				InValue |= NVSDK_NGX_DLSS_Feature_Flags_AlphaUpscaling;
-			}
-			else if (settings.overrideAlphaUpscaling < 0) // force disable alpha-upscaling
-			{
-				spdlog::debug("OverrideAlphaUpscaling: force disabling flag NVSDK_NGX_DLSS_Feature_Flags_AlphaUpscaling");
-				InValue = InValue & ~NVSDK_NGX_DLSS_Feature_Flags_AlphaUpscaling;
-			}
-		}
-
-		if (settings.overrideSharpeningForceDisable)
-		{
-			if (InValue & NVSDK_NGX_DLSS_Feature_Flags_DoSharpening)
-			{
-				spdlog::info("OverrideSharpening: force disabling flag NVSDK_NGX_DLSS_Feature_Flags_DoSharpening");
-				InValue = InValue & ~NVSDK_NGX_DLSS_Feature_Flags_DoSharpening;
-			}
-		}
-		else if (settings.overrideSharpening.has_value())
-		{
-			if ((InValue & NVSDK_NGX_DLSS_Feature_Flags_DoSharpening) != NVSDK_NGX_DLSS_Feature_Flags_DoSharpening)
-			{
-				spdlog::debug("OverrideSharpening: force enabling flag NVSDK_NGX_DLSS_Feature_Flags_DoSharpening");
-				InValue |= NVSDK_NGX_DLSS_Feature_Flags_DoSharpening;
-			}
-		}
+		const hook_logic::FeatureFlagOverrides overrides{
+			current->overrideHDR,
+			current->overrideAutoExposure,
+			current->overrideAlphaUpscaling,
+			current->overrideSharpeningForceDisable,
+			current->overrideSharpening.has_value(),
+		};
+		const int overriddenFlags = hook_logic::override_feature_flags(InValue, overrides);
+		log_flag_overrides(InValue, overriddenFlags);
+		InValue = overriddenFlags;
 	}
 
 	// Cache the chosen quality value so we can make decisions on it later on
@@ -309,130 +317,98 @@ void __cdecl NVSDK_NGX_Parameter_SetI(NVSDK_NGX_Parameter* InParameter, const ch
 		// Some games may expose an UltraQuality option if we returned a valid resolution for it
 		// DLSS usually doesn't like being asked to use UltraQuality though, and will break rendering/crash altogether if set
 		// So we'll just tell DLSS to use MaxQuality instead, while keeping UltraQuality stored in prevQualityValue
-		if (dlss.prevQualityLevel == NVSDK_NGX_PerfQuality_Value_UltraQuality)
-		{
-			const auto& ultraQuality = settings.qualities[NVSDK_NGX_PerfQuality_Value_UltraQuality];
-			if (utility::ValidResolution(ultraQuality.resolution) || ultraQuality.scalingRatio > 0.f)
-				InValue = int(NVSDK_NGX_PerfQuality_Value_MaxQuality);
-		}
+		InValue = hook_logic::dlss_quality_value(InValue, current->qualities[NVSDK_NGX_PerfQuality_Value_UltraQuality]);
 	}
 
-	NVSDK_NGX_Parameter_SetI_Hook.call(InParameter, InName, InValue);
+	NVSDK_NGX_Parameter_SetI_Hook.unsafe_call(InParameter, InName, InValue);
 }
 
-SafetyHookInline NVSDK_NGX_Parameter_SetUI_Hook;
+HookOrigFn NVSDK_NGX_Parameter_SetUI_Hook;
 void __cdecl NVSDK_NGX_Parameter_SetUI(NVSDK_NGX_Parameter* InParameter, const char* InName, unsigned int InValue)
 {
-	NVSDK_NGX_Parameter_SetUI_Hook.call(InParameter, InName, InValue);
+	NVSDK_NGX_Parameter_SetUI_Hook.unsafe_call(InParameter, InName, InValue);
 
+	const auto current = current_settings();
 
-	unsigned int presetDLAA = settings.qualities[NVSDK_NGX_PerfQuality_Value_DLAA].preset;
-	unsigned int presetQuality = settings.qualities[NVSDK_NGX_PerfQuality_Value_MaxQuality].preset;
-	unsigned int presetBalanced = settings.qualities[NVSDK_NGX_PerfQuality_Value_Balanced].preset;
-	unsigned int presetPerformance = settings.qualities[NVSDK_NGX_PerfQuality_Value_MaxPerf].preset;
-	unsigned int presetUltraPerformance = settings.qualities[NVSDK_NGX_PerfQuality_Value_UltraPerformance].preset;
-	unsigned int presetUltraQuality = settings.qualities[NVSDK_NGX_PerfQuality_Value_UltraQuality].preset;
+	unsigned int presetDLAA = current->qualities[NVSDK_NGX_PerfQuality_Value_DLAA].preset;
+	unsigned int presetQuality = current->qualities[NVSDK_NGX_PerfQuality_Value_MaxQuality].preset;
+	unsigned int presetBalanced = current->qualities[NVSDK_NGX_PerfQuality_Value_Balanced].preset;
+	unsigned int presetPerformance = current->qualities[NVSDK_NGX_PerfQuality_Value_MaxPerf].preset;
+	unsigned int presetUltraPerformance = current->qualities[NVSDK_NGX_PerfQuality_Value_UltraPerformance].preset;
+	unsigned int presetUltraQuality = current->qualities[NVSDK_NGX_PerfQuality_Value_UltraQuality].preset;
 
 	if (presetDLAA != NVSDK_NGX_DLSS_Hint_Render_Preset_Default)
-		NVSDK_NGX_Parameter_SetUI_Hook.call(InParameter, NVSDK_NGX_Parameter_DLSS_Hint_Render_Preset_DLAA, presetDLAA);
+		NVSDK_NGX_Parameter_SetUI_Hook.unsafe_call(InParameter, NVSDK_NGX_Parameter_DLSS_Hint_Render_Preset_DLAA, presetDLAA);
 	if (presetQuality != NVSDK_NGX_DLSS_Hint_Render_Preset_Default)
-		NVSDK_NGX_Parameter_SetUI_Hook.call(InParameter, NVSDK_NGX_Parameter_DLSS_Hint_Render_Preset_Quality, presetQuality);
+		NVSDK_NGX_Parameter_SetUI_Hook.unsafe_call(InParameter, NVSDK_NGX_Parameter_DLSS_Hint_Render_Preset_Quality, presetQuality);
 	if (presetBalanced != NVSDK_NGX_DLSS_Hint_Render_Preset_Default)
-		NVSDK_NGX_Parameter_SetUI_Hook.call(InParameter, NVSDK_NGX_Parameter_DLSS_Hint_Render_Preset_Balanced, presetBalanced);
+		NVSDK_NGX_Parameter_SetUI_Hook.unsafe_call(InParameter, NVSDK_NGX_Parameter_DLSS_Hint_Render_Preset_Balanced, presetBalanced);
 	if (presetPerformance != NVSDK_NGX_DLSS_Hint_Render_Preset_Default)
-		NVSDK_NGX_Parameter_SetUI_Hook.call(InParameter, NVSDK_NGX_Parameter_DLSS_Hint_Render_Preset_Performance, presetPerformance);
+		NVSDK_NGX_Parameter_SetUI_Hook.unsafe_call(InParameter, NVSDK_NGX_Parameter_DLSS_Hint_Render_Preset_Performance, presetPerformance);
 	if (presetUltraPerformance != NVSDK_NGX_DLSS_Hint_Render_Preset_Default)
-		NVSDK_NGX_Parameter_SetUI_Hook.call(InParameter, NVSDK_NGX_Parameter_DLSS_Hint_Render_Preset_UltraPerformance, presetUltraPerformance);
+		NVSDK_NGX_Parameter_SetUI_Hook.unsafe_call(InParameter, NVSDK_NGX_Parameter_DLSS_Hint_Render_Preset_UltraPerformance, presetUltraPerformance);
 	if (presetUltraQuality != NVSDK_NGX_DLSS_Hint_Render_Preset_Default)
-		NVSDK_NGX_Parameter_SetUI_Hook.call(InParameter, NVSDK_NGX_Parameter_DLSS_Hint_Render_Preset_UltraQuality, presetUltraQuality);
+		NVSDK_NGX_Parameter_SetUI_Hook.unsafe_call(InParameter, NVSDK_NGX_Parameter_DLSS_Hint_Render_Preset_UltraQuality, presetUltraQuality);
 
 
-	if (settings.overrideSharpening.has_value())
-		NVSDK_NGX_Parameter_SetF_Hook.call(InParameter, NVSDK_NGX_Parameter_Sharpness, *settings.overrideSharpening);
+	if (current->overrideSharpening.has_value())
+		NVSDK_NGX_Parameter_SetF_Hook.unsafe_call(InParameter, NVSDK_NGX_Parameter_Sharpness, *current->overrideSharpening);
 
-	NVSDK_NGX_Parameter_SetUI_Hook.call(InParameter, NVSDK_NGX_Parameter_Disable_Watermark, settings.disableDevWatermark ? 1 : 0);
+	NVSDK_NGX_Parameter_SetUI_Hook.unsafe_call(InParameter, NVSDK_NGX_Parameter_Disable_Watermark, current->disableDevWatermark ? 1 : 0);
 }
 
-SafetyHookInline NVSDK_NGX_Parameter_GetUI_Hook;
+HookOrigFn NVSDK_NGX_Parameter_GetUI_Hook;
 NVSDK_NGX_Result __cdecl NVSDK_NGX_Parameter_GetUI(NVSDK_NGX_Parameter* InParameter, const char* InName, unsigned int* OutValue)
 {
-	auto ret = NVSDK_NGX_Parameter_GetUI_Hook.call<NVSDK_NGX_Result>(InParameter, InName, OutValue);
+	auto ret = NVSDK_NGX_Parameter_GetUI_Hook.unsafe_call<NVSDK_NGX_Result>(InParameter, InName, OutValue);
 	if (ret != NVSDK_NGX_Result_Success)
 		return ret;
 
 	auto OutValueOrig = *OutValue;
+	const auto current = current_settings();
 
-	bool isDynamicRes = settings.dynamicResolutionOverride && strstr(InName, NVSDK_NGX_Parameter_DLSS_Get_Dynamic) == InName;
-
-	bool isOutWidth = !_stricmp(InName, NVSDK_NGX_Parameter_OutWidth) ||
-		(isDynamicRes && (
-			!_stricmp(InName, NVSDK_NGX_Parameter_DLSS_Get_Dynamic_Max_Render_Width) ||
-			!_stricmp(InName, NVSDK_NGX_Parameter_DLSS_Get_Dynamic_Min_Render_Width)));
-
-	bool isOutHeight = !_stricmp(InName, NVSDK_NGX_Parameter_OutHeight) ||
-		(isDynamicRes && (
-			!_stricmp(InName, NVSDK_NGX_Parameter_DLSS_Get_Dynamic_Max_Render_Height) ||
-			!_stricmp(InName, NVSDK_NGX_Parameter_DLSS_Get_Dynamic_Min_Render_Height)));
+	const auto query = hook_logic::classify_resolution_query(InName, current->dynamicResolutionOverride);
+	const bool isOutWidth = query.width;
+	const bool isOutHeight = query.height;
 
 	bool isOutValueOverridden = false;
 
 	// DLAA force by overwriting OutWidth/OutHeight with the full res
-	bool overrideWidth = settings.forceDLAA && isOutWidth;
-	bool overrideHeight = settings.forceDLAA && isOutHeight;
+	bool overrideWidth = current->forceDLAA && isOutWidth;
+	bool overrideHeight = current->forceDLAA && isOutHeight;
 	if (overrideWidth || overrideHeight)
 	{
 		if (overrideWidth && *OutValue != 0)
 		{
-			NVSDK_NGX_Parameter_GetUI_Hook.call(InParameter, NVSDK_NGX_Parameter_Width, OutValue);
-			*OutValue += settings.resolutionOffset;
+			NVSDK_NGX_Parameter_GetUI_Hook.unsafe_call(InParameter, NVSDK_NGX_Parameter_Width, OutValue);
+			*OutValue += current->resolutionOffset;
 			isOutValueOverridden = true;
 		}
 		if (overrideHeight && *OutValue != 0)
 		{
-			NVSDK_NGX_Parameter_GetUI_Hook.call(InParameter, NVSDK_NGX_Parameter_Height, OutValue);
-			*OutValue += settings.resolutionOffset;
+			NVSDK_NGX_Parameter_GetUI_Hook.unsafe_call(InParameter, NVSDK_NGX_Parameter_Height, OutValue);
+			*OutValue += current->resolutionOffset;
 			isOutValueOverridden = true;
 		}
 	}
 
 	// Override with DLSSQualityLevels value if user set it
-	if (settings.overrideQualityLevels && (isOutWidth || isOutHeight))
+	if (current->overrideQualityLevels && (isOutWidth || isOutHeight))
 	{
 		unsigned int targetWidth = 0;
 		unsigned int targetHeight = 0;
-		NVSDK_NGX_Parameter_GetUI_Hook.call(InParameter, NVSDK_NGX_Parameter_Width, &targetWidth); // fetch full screen width
-		NVSDK_NGX_Parameter_GetUI_Hook.call(InParameter, NVSDK_NGX_Parameter_Height, &targetHeight); // fetch full screen height
+		NVSDK_NGX_Parameter_GetUI_Hook.unsafe_call(InParameter, NVSDK_NGX_Parameter_Width, &targetWidth); // fetch full screen width
+		NVSDK_NGX_Parameter_GetUI_Hook.unsafe_call(InParameter, NVSDK_NGX_Parameter_Height, &targetHeight); // fetch full screen height
 			
 		unsigned int renderWidth = 0;
 		unsigned int renderHeight = 0;
-		if (settings.qualities.contains(dlss.prevQualityLevel))
+		if (current->qualities.contains(dlss.prevQualityLevel))
 		{
-			auto& quality = settings.qualities[dlss.prevQualityLevel];
-
-			// calculate width/height from custom ratio
-			renderWidth = unsigned int(roundf(float(targetWidth) * quality.scalingRatio));
-			renderHeight = unsigned int(roundf(float(targetHeight) * quality.scalingRatio));
-
-			// ..but if custom res is set for this level, override it with that
-			if (utility::ValidResolution(quality.resolution))
-			{
-				renderWidth = quality.resolution.first;
-				renderHeight = quality.resolution.second;
-			}
-
-			if (renderWidth >= targetWidth)
-			{
-				renderWidth = targetWidth; // DLSS can't render above the target res
-				renderWidth += settings.resolutionOffset; // apply resolutionOffset compatibility hack
-			}
-			if (renderHeight >= targetHeight)
-			{
-				renderHeight = targetHeight; // DLSS can't render above the target res
-				renderHeight += settings.resolutionOffset; // apply resolutionOffset compatibility hack
-			}
+			const auto& quality = current->qualities[dlss.prevQualityLevel];
+			std::tie(renderWidth, renderHeight) = hook_logic::render_resolution(quality, targetWidth, targetHeight, current->resolutionOffset);
 
 			if (renderWidth != 0 && renderHeight != 0)
-				quality.currentResolution = std::pair<int, int>(renderWidth, renderHeight);
+				dlss.reportedResolutions[size_t(dlss.prevQualityLevel)] = std::pair<int, int>(renderWidth, renderHeight);
 		}
 
 		if (isOutWidth)
@@ -449,15 +425,9 @@ NVSDK_NGX_Result __cdecl NVSDK_NGX_Parameter_GetUI(NVSDK_NGX_Parameter* InParame
 
 	if (isOutValueOverridden)
 	{
-		if (isDynamicRes)
+		if (query.dynamicMin && *OutValue > 0)
 		{
-			bool isDynamicMin =
-				!_stricmp(InName, NVSDK_NGX_Parameter_DLSS_Get_Dynamic_Min_Render_Width) ||
-				!_stricmp(InName, NVSDK_NGX_Parameter_DLSS_Get_Dynamic_Min_Render_Height);
-			if (isDynamicMin && *OutValue > 0)
-			{
-				*OutValue = *OutValue + settings.dynamicResolutionMinOffset;
-			}
+			*OutValue = *OutValue + current->dynamicResolutionMinOffset;
 		}
 
 		spdlog::debug("NVSDK_NGX_Parameter_GetUI: {} -> {} (orig value: {})", InName, *OutValue, OutValueOrig);
@@ -569,14 +539,82 @@ PLUGIN_API NVSDK_NGX_Result __cdecl NVSDK_NGX_VULKAN_GetParameters(NVSDK_NGX_Par
 }
 
 std::mutex paramHookMutex;
+bool paramHooksApplied = false;
+
+// Latched by the first hook_params call, so a later VTableParamHooks change can't end up mixing the two ways of hooking
+enum class ParamHookMode
+{
+	Unset,
+	Inline,
+	Shadow,
+};
+ParamHookMode paramHookMode = ParamHookMode::Unset;
+
+// VTableParamHooks mode: parameter objects handed to the game get their vftable pointer swapped to a shadow copy holding our hooks
+// Objects that _nvngx & the DLSS modules use internally never pass through here, so they keep calling the original functions directly
+// Slots past Reset (destructors etc) aren't known to us, so a fixed number of them are copied over too, along with the RTTI locator before the table
+constexpr size_t ShadowVftableSlots = 32;
+const NVSDK_NGX_Parameter_vftable* origParamVftable = nullptr;
+void* shadowParamVftable[ShadowVftableSlots + 1]{}; // [0] = RTTI complete object locator, vftable starts at [1]
+
+bool create_shadow_vftable(const NVSDK_NGX_Parameter_vftable* vftable)
+{
+	auto* origSlots = (void* const*)vftable - 1;
+	size_t numSlots = ShadowVftableSlots + 1;
+
+	// Don't read past the end of the region holding the vftable
+	MEMORY_BASIC_INFORMATION mbi{};
+	if (!VirtualQuery(origSlots, &mbi, sizeof(mbi)) || mbi.State != MEM_COMMIT)
+		return false;
+	const size_t available = (uintptr_t(mbi.BaseAddress) + mbi.RegionSize - uintptr_t(origSlots)) / sizeof(void*);
+	numSlots = std::min(numSlots, available);
+	if (numSlots <= sizeof(NVSDK_NGX_Parameter_vftable) / sizeof(void*))
+		return false;
+
+	std::copy_n(origSlots, numSlots, shadowParamVftable);
+
+	auto* shadow = (NVSDK_NGX_Parameter_vftable*)&shadowParamVftable[1];
+	NVSDK_NGX_Parameter_SetF_Hook = FARPROC(vftable->SetF);
+	NVSDK_NGX_Parameter_SetI_Hook = FARPROC(vftable->SetI);
+	NVSDK_NGX_Parameter_SetUI_Hook = FARPROC(vftable->SetUI);
+	NVSDK_NGX_Parameter_GetUI_Hook = FARPROC(vftable->GetUI);
+	shadow->SetF = (void*)&NVSDK_NGX_Parameter_SetF;
+	shadow->SetI = (void*)&NVSDK_NGX_Parameter_SetI;
+	shadow->SetUI = (void*)&NVSDK_NGX_Parameter_SetUI;
+	shadow->GetUI = (void*)&NVSDK_NGX_Parameter_GetUI;
+
+	origParamVftable = vftable;
+	return true;
+}
+
+// Returns false if the shadow vftable couldn't be created
+bool shadow_params(NVSDK_NGX_Parameter* params)
+{
+	auto** vftable = (const NVSDK_NGX_Parameter_vftable**)params;
+
+	if (!origParamVftable)
+	{
+		if (!create_shadow_vftable(*vftable))
+		{
+			spdlog::warn("NVSDK_NGX_Parameter: failed to copy vftable, falling back to inline parameter hooks");
+			return false;
+		}
+
+		spdlog::info("DLSS functions found & parameter vftable hooks applied!");
+		current_settings()->print_to_log();
+	}
+
+	// Objects that were already shadowed (GetParameters returns the same one each time) or that belong to some other class are left as-is
+	if (*vftable == origParamVftable)
+		*vftable = (const NVSDK_NGX_Parameter_vftable*)&shadowParamVftable[1];
+	return true;
+}
+
 void hook_params(NVSDK_NGX_Parameter* params)
 {
 	std::scoped_lock lock{paramHookMutex};
 
-	if (settings.disableAllTweaks)
-		return;
-
-	if (NVSDK_NGX_Parameter_SetF_Hook && NVSDK_NGX_Parameter_SetI_Hook && NVSDK_NGX_Parameter_SetUI_Hook && NVSDK_NGX_Parameter_GetUI_Hook)
+	if (current_settings()->disableAllTweaks)
 		return;
 
 	auto** vftable = (NVSDK_NGX_Parameter_vftable**)params;
@@ -584,6 +622,26 @@ void hook_params(NVSDK_NGX_Parameter* params)
 	if (!vftable || !*vftable)
 		return;
 
+	if (paramHookMode == ParamHookMode::Unset)
+		paramHookMode = current_settings()->vtableParamHooks ? ParamHookMode::Shadow : ParamHookMode::Inline;
+
+	// Every new parameter object needs its own swap, so the export hooks stay active in this mode
+	if (paramHookMode == ParamHookMode::Shadow)
+	{
+		if (shadow_params(params))
+			return;
+
+		// Only tried once, inline hooks are used from now on instead
+		paramHookMode = ParamHookMode::Inline;
+	}
+
+	if (paramHooksApplied)
+		return;
+
+	// Objects given the shadow vftable already call into our hooks, hooking their functions would make the hooks call themselves
+	if (*vftable == (NVSDK_NGX_Parameter_vftable*)&shadowParamVftable[1])
+		return;
+
 	auto* NVSDK_NGX_Parameter_SetF_orig = (*vftable)->SetF;
 	auto* NVSDK_NGX_Parameter_SetI_orig = (*vftable)->SetI;
 	auto* NVSDK_NGX_Parameter_SetUI_orig = (*vftable)->SetUI;
@@ -591,13 +649,19 @@ void hook_params(NVSDK_NGX_Parameter* params)
 
 	if (NVSDK_NGX_Parameter_SetF_orig && NVSDK_NGX_Parameter_SetI_orig && NVSDK_NGX_Parameter_SetUI_orig && NVSDK_NGX_Parameter_GetUI_orig)
 	{
-		NVSDK_NGX_Parameter_SetF_Hook = safetyhook::create_inline(NVSDK_NGX_Parameter_SetF_orig, NVSDK_NGX_Parameter_SetF);
-		NVSDK_NGX_Parameter_SetI_Hook = safetyhook::create_inline(NVSDK_NGX_Parameter_SetI_orig, NVSDK_NGX_Parameter_SetI);
-		NVSDK_NGX_Parameter_SetUI_Hook = safetyhook::create_inline(NVSDK_NGX_Parameter_SetUI_orig, NVSDK_NGX_Parameter_SetUI);
-		NVSDK_NGX_Parameter_GetUI_Hook = safetyhook::create_inline(NVSDK_NGX_Parameter_GetUI_orig, NVSDK_NGX_Parameter_GetUI);
+		HookBatch batch;
+		batch.add(NVSDK_NGX_Parameter_SetF_orig, NVSDK_NGX_Parameter_SetF, NVSDK_NGX_Parameter_SetF_Hook);
+		batch.add(NVSDK_NGX_Parameter_SetI_orig, NVSDK_NGX_Parameter_SetI, NVSDK_NGX_Parameter_SetI_Hook);
+		batch.add(NVSDK_NGX_Parameter_SetUI_orig, NVSDK_NGX_Parameter_SetUI, NVSDK_NGX_Parameter_SetUI_Hook);
+		batch.add(NVSDK_NGX_Parameter_GetUI_orig, NVSDK_NGX_Parameter_GetUI, NVSDK_NGX_Parameter_GetUI_Hook);
+		const size_t numHooks = batch.size(); // apply() empties the batch
+		if (batch.apply() != numHooks)
+			return;
+
+		paramHooksApplied = true;
 
 		spdlog::info("DLSS functions found & parameter hooks applied!");
-		settings.print_to_log();
+		current_settings()->print_to_log();
 
 		// disable NGX param export hooks since they aren't needed now
 		NVSDK_NGX_D3D11_AllocateParameters_Hook.reset();
@@ -614,87 +678,193 @@ void hook_params(NVSDK_NGX_Parameter* params)
 	}
 }
 
+// Every _nvngx export we intercept, in the order hooks are applied
+struct ExportHook
+{
+	const char* name;
+	void* detour;
+	HookOrigFn* hook;
+	bool optional; // only in later drivers
+};
+
+const ExportHook ExportHooks[] =
+{
+	{ "NVSDK_NGX_D3D11_EvaluateFeature", (void*)&NVSDK_NGX_D3D11_EvaluateFeature, &NVSDK_NGX_D3D11_EvaluateFeature_Hook, false },
+	{ "NVSDK_NGX_D3D11_Init", (void*)&NVSDK_NGX_D3D11_Init, &NVSDK_NGX_D3D11_Init_Hook, false },
+	{ "NVSDK_NGX_D3D11_Init_Ext", (void*)&NVSDK_NGX_D3D11_Init_Ext, &NVSDK_NGX_D3D11_Init_Ext_Hook, false },
+	{ "NVSDK_NGX_D3D11_Init_ProjectID", (void*)&NVSDK_NGX_D3D11_Init_ProjectID, &NVSDK_NGX_D3D11_Init_ProjectID_Hook, false },
+	{ "NVSDK_NGX_D3D11_AllocateParameters", (void*)&NVSDK_NGX_D3D11_AllocateParameters, &NVSDK_NGX_D3D11_AllocateParameters_Hook, false },
+	{ "NVSDK_NGX_D3D11_GetCapabilityParameters", (void*)&NVSDK_NGX_D3D11_GetCapabilityParameters, &NVSDK_NGX_D3D11_GetCapabilityParameters_Hook, false },
+	{ "NVSDK_NGX_D3D11_GetParameters", (void*)&NVSDK_NGX_D3D11_GetParameters, &NVSDK_NGX_D3D11_GetParameters_Hook, false },
+
+	{ "NVSDK_NGX_D3D12_EvaluateFeature", (void*)&NVSDK_NGX_D3D12_EvaluateFeature, &NVSDK_NGX_D3D12_EvaluateFeature_Hook, false },
+	{ "NVSDK_NGX_D3D12_Init", (void*)&NVSDK_NGX_D3D12_Init, &NVSDK_NGX_D3D12_Init_Hook, false },
+	{ "NVSDK_NGX_D3D12_Init_Ext", (void*)&NVSDK_NGX_D3D12_Init_Ext, &NVSDK_NGX_D3D12_Init_Ext_Hook, false },
+	{ "NVSDK_NGX_D3D12_Init_ProjectID", (void*)&NVSDK_NGX_D3D12_Init_ProjectID, &NVSDK_NGX_D3D12_Init_ProjectID_Hook, false },
+	{ "NVSDK_NGX_D3D12_AllocateParameters", (void*)&NVSDK_NGX_D3D12_AllocateParameters, &NVSDK_NGX_D3D12_AllocateParameters_Hook, false },
+	{ "NVSDK_NGX_D3D12_GetCapabilityParameters", (void*)&NVSDK_NGX_D3D12_GetCapabilityParameters, &NVSDK_NGX_D3D12_GetCapabilityParameters_Hook, false },
+	{ "NVSDK_NGX_D3D12_GetParameters", (void*)&NVSDK_NGX_D3D12_GetParameters, &NVSDK_NGX_D3D12_GetParameters_Hook, false },
+
+	{ "NVSDK_NGX_VULKAN_EvaluateFeature", (void*)&NVSDK_NGX_VULKAN_EvaluateFeature, &NVSDK_NGX_VULKAN_EvaluateFeature_Hook, false },
+	{ "NVSDK_NGX_VULKAN_Init", (void*)&NVSDK_NGX_VULKAN_Init, &NVSDK_NGX_VULKAN_Init_Hook, false },
+	{ "NVSDK_NGX_VULKAN_Init_Ext", (void*)&NVSDK_NGX_VULKAN_Init_Ext, &NVSDK_NGX_VULKAN_Init_Ext_Hook, false },
+	{ "NVSDK_NGX_VULKAN_Init_ProjectID", (void*)&NVSDK_NGX_VULKAN_Init_ProjectID, &NVSDK_NGX_VULKAN_Init_ProjectID_Hook, false },
+	{ "NVSDK_NGX_VULKAN_Init_Ext2", (void*)&NVSDK_NGX_VULKAN_Init_Ext2, &NVSDK_NGX_VULKAN_Init_Ext2_Hook, true },
+	{ "NVSDK_NGX_VULKAN_Init_ProjectID_Ext", (void*)&NVSDK_NGX_VULKAN_Init_ProjectID_Ext, &NVSDK_NGX_VULKAN_Init_ProjectID_Ext_Hook, true },
+	{ "NVSDK_NGX_VULKAN_AllocateParameters", (void*)&NVSDK_NGX_VULKAN_AllocateParameters, &NVSDK_NGX_VULKAN_AllocateParameters_Hook, false },
+	{ "NVSDK_NGX_VULKAN_GetCapabilityParameters", (void*)&NVSDK_NGX_VULKAN_GetCapabilityParameters, &NVSDK_NGX_VULKAN_GetCapabilityParameters_Hook, false },
+	{ "NVSDK_NGX_VULKAN_GetParameters", (void*)&NVSDK_NGX_VULKAN_GetParameters, &NVSDK_NGX_VULKAN_GetParameters_Hook, false },
+};
+
+// IATHooks mode: instead of patching _nvngx code, the game's own pointers to it are swapped over to our hooks
+// Imports of _nvngx get patched in every module loaded at that point, and GetProcAddress lookups on it are redirected through GetProcAddress_Hook
+// Modules loaded afterwards aren't patched: loader notifications arrive before their imports are bound, so any patch would just be overwritten
+// Our hooks then call _nvngx directly via HookOrigFn::dest_proc, so there's no trampoline involved & no threads need to be suspended
+std::atomic<HMODULE> redirectModule = nullptr; // _nvngx module that GetProcAddress results are being redirected for
+PatchSet importPatches; // only touched under the loader lock (from init/unhook)
+
+FARPROC WINAPI GetProcAddress_Hook(HMODULE hModule, LPCSTR lpProcName)
+{
+	// Our own imports are never patched, so this is the real GetProcAddress
+	FARPROC proc = GetProcAddress(hModule, lpProcName);
+
+	// Ordinal lookups (low word only) aren't something the NGX SDK does, those are passed through untouched
+	if (proc && hModule == redirectModule.load(std::memory_order_acquire) && !IS_INTRESOURCE(lpProcName))
+	{
+		for (const auto& exportHook : ExportHooks)
+			if (!strcmp(exportHook.name, lpProcName))
+				return (FARPROC)exportHook.detour;
+	}
+
+	return proc;
+}
+
+bool redirect_imports(HMODULE ngx_module, const FARPROC* origs)
+{
+	HMODULE ourModule = nullptr;
+	GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT, (LPCWSTR)&GetProcAddress_Hook, &ourModule);
+
+	HMODULE modules[1024];
+	DWORD bytesNeeded = 0;
+	if (!K32EnumProcessModules(GetCurrentProcess(), modules, sizeof(modules), &bytesNeeded))
+		return false;
+
+	// GetProcAddress is imported through kernel32 by most games, newer toolchains can also import it through the API set instead
+	constexpr std::string_view GetProcAddressModules[] = { "kernel32.dll", "api-ms-win-core-libraryloader-l1-1-0.dll", "api-ms-win-core-libraryloader-l1-2-0.dll" };
+
+	importPatches.clear();
+	size_t numGetProcAddress = 0;
+	size_t numImports = 0;
+
+	const size_t numModules = std::min<size_t>(bytesNeeded / sizeof(HMODULE), std::size(modules));
+	for (size_t i = 0; i < numModules; i++)
+	{
+		HMODULE module = modules[i];
+		if (module == ourModule || module == ngx_module)
+			continue;
+
+		pe::Image image;
+		if (!image.parse_mapped(module) || !image.num_imports())
+			continue;
+
+		for (const auto& importModule : GetProcAddressModules)
+		{
+			if (const uint32_t thunkRva = image.find_import(importModule, "GetProcAddress"))
+			{
+				importPatches.add((uint8_t*)module + thunkRva, (void*)&GetProcAddress_Hook);
+				numGetProcAddress++;
+			}
+		}
+
+		// Linking against _nvngx directly is rare, but those imports were resolved to the real exports before we got here
+		for (size_t j = 0; j < std::size(ExportHooks); j++)
+		{
+			if (!origs[j])
+				continue;
+			if (const uint32_t thunkRva = image.find_import("_nvngx.dll", ExportHooks[j].name))
+			{
+				importPatches.add((uint8_t*)module + thunkRva, ExportHooks[j].detour);
+				numImports++;
+			}
+		}
+	}
+
+	// Nothing would ever reach our hooks without either of these
+	if (!numGetProcAddress && !numImports)
+		return false;
+
+	if (!importPatches.apply())
+	{
+		importPatches.clear();
+		return false;
+	}
+
+	redirectModule.store(ngx_module, std::memory_order_release);
+	spdlog::debug("nvngx: patched {} GetProcAddress import(s) & {} _nvngx import(s)", numGetProcAddress, numImports);
+	return true;
+}
+
 void hook(HMODULE ngx_module)
 {
-	auto* NVSDK_NGX_D3D11_EvaluateFeature_orig = GetProcAddress(ngx_module, "NVSDK_NGX_D3D11_EvaluateFeature");
-	auto* NVSDK_NGX_D3D11_Init_orig = GetProcAddress(ngx_module, "NVSDK_NGX_D3D11_Init");
-	auto* NVSDK_NGX_D3D11_Init_Ext_orig = GetProcAddress(ngx_module, "NVSDK_NGX_D3D11_Init_Ext");
-	auto* NVSDK_NGX_D3D11_Init_ProjectID_orig = GetProcAddress(ngx_module, "NVSDK_NGX_D3D11_Init_ProjectID");
-	auto* NVSDK_NGX_D3D11_AllocateParameters_orig = GetProcAddress(ngx_module, "NVSDK_NGX_D3D11_AllocateParameters");
-	auto* NVSDK_NGX_D3D11_GetCapabilityParameters_orig = GetProcAddress(ngx_module, "NVSDK_NGX_D3D11_GetCapabilityParameters");
-	auto* NVSDK_NGX_D3D11_GetParameters_orig = GetProcAddress(ngx_module, "NVSDK_NGX_D3D11_GetParameters");
-
-	auto* NVSDK_NGX_D3D12_EvaluateFeature_orig = GetProcAddress(ngx_module, "NVSDK_NGX_D3D12_EvaluateFeature");
-	auto* NVSDK_NGX_D3D12_Init_orig = GetProcAddress(ngx_module, "NVSDK_NGX_D3D12_Init");
-	auto* NVSDK_NGX_D3D12_Init_Ext_orig = GetProcAddress(ngx_module, "NVSDK_NGX_D3D12_Init_Ext");
-	auto* NVSDK_NGX_D3D12_Init_ProjectID_orig = GetProcAddress(ngx_module, "NVSDK_NGX_D3D12_Init_ProjectID");
-	auto* NVSDK_NGX_D3D12_AllocateParameters_orig = GetProcAddress(ngx_module, "NVSDK_NGX_D3D12_AllocateParameters");
-	auto* NVSDK_NGX_D3D12_GetCapabilityParameters_orig = GetProcAddress(ngx_module, "NVSDK_NGX_D3D12_GetCapabilityParameters");
-	auto* NVSDK_NGX_D3D12_GetParameters_orig = GetProcAddress(ngx_module, "NVSDK_NGX_D3D12_GetParameters");
-
-	auto* NVSDK_NGX_VULKAN_EvaluateFeature_orig = GetProcAddress(ngx_module, "NVSDK_NGX_VULKAN_EvaluateFeature");
-	auto* NVSDK_NGX_VULKAN_Init_orig = GetProcAddress(ngx_module, "NVSDK_NGX_VULKAN_Init");
-	auto* NVSDK_NGX_VULKAN_Init_Ext_orig = GetProcAddress(ngx_module, "NVSDK_NGX_VULKAN_Init_Ext");
-	auto* NVSDK_NGX_VULKAN_Init_Ext2_orig = GetProcAddress(ngx_module, "NVSDK_NGX_VULKAN_Init_Ext2");
-	auto* NVSDK_NGX_VULKAN_Init_ProjectID_orig = GetProcAddress(ngx_module, "NVSDK_NGX_VULKAN_Init_ProjectID");
-	auto* NVSDK_NGX_VULKAN_Init_ProjectID_Ext_orig = GetProcAddress(ngx_module, "NVSDK_NGX_VULKAN_Init_ProjectID_Ext");
-	auto* NVSDK_NGX_VULKAN_AllocateParameters_orig = GetProcAddress(ngx_module, "NVSDK_NGX_VULKAN_AllocateParameters");
-	auto* NVSDK_NGX_VULKAN_GetCapabilityParameters_orig = GetProcAddress(ngx_module, "NVSDK_NGX_VULKAN_GetCapabilityParameters");
-	auto* NVSDK_NGX_VULKAN_GetParameters_orig = GetProcAddress(ngx_module, "NVSDK_NGX_VULKAN_GetParameters");
-
-	// Make sure we only try hooking if we found all the procs above...
-	if (NVSDK_NGX_D3D11_EvaluateFeature_orig && NVSDK_NGX_D3D11_Init_orig && NVSDK_NGX_D3D11_Init_Ext_orig && NVSDK_NGX_D3D11_Init_ProjectID_orig &&
-		NVSDK_NGX_D3D11_AllocateParameters_orig && NVSDK_NGX_D3D11_GetCapabilityParameters_orig && NVSDK_NGX_D3D11_GetParameters_orig &&
-		NVSDK_NGX_D3D12_EvaluateFeature_orig && NVSDK_NGX_D3D12_Init_orig && NVSDK_NGX_D3D12_Init_Ext_orig && NVSDK_NGX_D3D12_Init_ProjectID_orig &&
-		NVSDK_NGX_D3D12_AllocateParameters_orig && NVSDK_NGX_D3D12_GetCapabilityParameters_orig && NVSDK_NGX_D3D12_GetParameters_orig &&
-		NVSDK_NGX_VULKAN_EvaluateFeature_orig && NVSDK_NGX_VULKAN_Init_orig && NVSDK_NGX_VULKAN_Init_Ext_orig && NVSDK_NGX_VULKAN_Init_ProjectID_orig &&
-		NVSDK_NGX_VULKAN_AllocateParameters_orig && NVSDK_NGX_VULKAN_GetCapabilityParameters_orig && NVSDK_NGX_VULKAN_GetParameters_orig)
+	// Parse the export table once up-front, all the lookups below are then just hash table probes
+	pe::Image image;
+	if (!image.parse_mapped(ngx_module))
 	{
-		NVSDK_NGX_D3D11_EvaluateFeature_Hook = safetyhook::create_inline(NVSDK_NGX_D3D11_EvaluateFeature_orig, NVSDK_NGX_D3D11_EvaluateFeature);
-		NVSDK_NGX_D3D11_Init_Hook = safetyhook::create_inline(NVSDK_NGX_D3D11_Init_orig, NVSDK_NGX_D3D11_Init);
-		NVSDK_NGX_D3D11_Init_Ext_Hook = safetyhook::create_inline(NVSDK_NGX_D3D11_Init_Ext_orig, NVSDK_NGX_D3D11_Init_Ext);
-		NVSDK_NGX_D3D11_Init_ProjectID_Hook = safetyhook::create_inline(NVSDK_NGX_D3D11_Init_ProjectID_orig, NVSDK_NGX_D3D11_Init_ProjectID);
-
-		NVSDK_NGX_D3D11_AllocateParameters_Hook = safetyhook::create_inline(NVSDK_NGX_D3D11_AllocateParameters_orig, NVSDK_NGX_D3D11_AllocateParameters);
-		NVSDK_NGX_D3D11_GetCapabilityParameters_Hook = safetyhook::create_inline(NVSDK_NGX_D3D11_GetCapabilityParameters_orig, NVSDK_NGX_D3D11_GetCapabilityParameters);
-		NVSDK_NGX_D3D11_GetParameters_Hook = safetyhook::create_inline(NVSDK_NGX_D3D11_GetParameters_orig, NVSDK_NGX_D3D11_GetParameters);
-
-		NVSDK_NGX_D3D12_EvaluateFeature_Hook = safetyhook::create_inline(NVSDK_NGX_D3D12_EvaluateFeature_orig, NVSDK_NGX_D3D12_EvaluateFeature);
-		NVSDK_NGX_D3D12_Init_Hook = safetyhook::create_inline(NVSDK_NGX_D3D12_Init_orig, NVSDK_NGX_D3D12_Init);
-		NVSDK_NGX_D3D12_Init_Ext_Hook = safetyhook::create_inline(NVSDK_NGX_D3D12_Init_Ext_orig, NVSDK_NGX_D3D12_Init_Ext);
-		NVSDK_NGX_D3D12_Init_ProjectID_Hook = safetyhook::create_inline(NVSDK_NGX_D3D12_Init_ProjectID_orig, NVSDK_NGX_D3D12_Init_ProjectID);
-
-		NVSDK_NGX_D3D12_AllocateParameters_Hook = safetyhook::create_inline(NVSDK_NGX_D3D12_AllocateParameters_orig, NVSDK_NGX_D3D12_AllocateParameters);
-		NVSDK_NGX_D3D12_GetCapabilityParameters_Hook = safetyhook::create_inline(NVSDK_NGX_D3D12_GetCapabilityParameters_orig, NVSDK_NGX_D3D12_GetCapabilityParameters);
-		NVSDK_NGX_D3D12_GetParameters_Hook = safetyhook::create_inline(NVSDK_NGX_D3D12_GetParameters_orig, NVSDK_NGX_D3D12_GetParameters);
-
-		NVSDK_NGX_VULKAN_EvaluateFeature_Hook = safetyhook::create_inline(NVSDK_NGX_VULKAN_EvaluateFeature_orig, NVSDK_NGX_VULKAN_EvaluateFeature);
-		NVSDK_NGX_VULKAN_Init_Hook = safetyhook::create_inline(NVSDK_NGX_VULKAN_Init_orig, NVSDK_NGX_VULKAN_Init);
-		NVSDK_NGX_VULKAN_Init_Ext_Hook = safetyhook::create_inline(NVSDK_NGX_VULKAN_Init_Ext_orig, NVSDK_NGX_VULKAN_Init_Ext);
-		NVSDK_NGX_VULKAN_Init_ProjectID_Hook = safetyhook::create_inline(NVSDK_NGX_VULKAN_Init_ProjectID_orig, NVSDK_NGX_VULKAN_Init_ProjectID);
-
-		// Only in later drivers
-		if (NVSDK_NGX_VULKAN_Init_Ext2_orig)
-			NVSDK_NGX_VULKAN_Init_Ext2_Hook = safetyhook::create_inline(NVSDK_NGX_VULKAN_Init_Ext2_orig, NVSDK_NGX_VULKAN_Init_Ext2);
-		if (NVSDK_NGX_VULKAN_Init_ProjectID_Ext_orig)
-			NVSDK_NGX_VULKAN_Init_ProjectID_Ext_Hook = safetyhook::create_inline(NVSDK_NGX_VULKAN_Init_ProjectID_Ext_orig, NVSDK_NGX_VULKAN_Init_ProjectID_Ext);
-
-		NVSDK_NGX_VULKAN_AllocateParameters_Hook = safetyhook::create_inline(NVSDK_NGX_VULKAN_AllocateParameters_orig, NVSDK_NGX_VULKAN_AllocateParameters);
-		NVSDK_NGX_VULKAN_GetCapabilityParameters_Hook = safetyhook::create_inline(NVSDK_NGX_VULKAN_GetCapabilityParameters_orig, NVSDK_NGX_VULKAN_GetCapabilityParameters);
-		NVSDK_NGX_VULKAN_GetParameters_Hook = safetyhook::create_inline(NVSDK_NGX_VULKAN_GetParameters_orig, NVSDK_NGX_VULKAN_GetParameters);
-
-		spdlog::info("nvngx: applied export hooks, waiting for game to call them...");
+		spdlog::error("nvngx: failed to parse module headers, can't hook exports");
+		return;
 	}
-	else
+
+	FARPROC origs[std::size(ExportHooks)];
+	for (size_t i = 0; i < std::size(ExportHooks); i++)
 	{
-		spdlog::error("nvngx: failed to locate some functions, may require driver update!");
+		origs[i] = utility::GetExport(ngx_module, image, ExportHooks[i].name);
+
+		// Make sure we only try hooking if we found all the procs above...
+		if (!origs[i] && !ExportHooks[i].optional)
+		{
+			spdlog::error("nvngx: failed to locate some functions, may require driver update!");
+			return;
+		}
 	}
+
+	if (current_settings()->iatHooks)
+	{
+		if (redirect_imports(ngx_module, origs))
+		{
+			// Hooks call straight into _nvngx now, nothing in it has been patched
+			for (size_t i = 0; i < std::size(ExportHooks); i++)
+				if (origs[i])
+					*ExportHooks[i].hook = origs[i];
+
+			spdlog::info("nvngx: redirected imports to our hooks, waiting for game to call them...");
+			return;
+		}
+
+		spdlog::warn("nvngx: failed to redirect imports, falling back to export hooks");
+	}
+
+	// Queue up all the export hooks and apply them together, so their trampolines share one allocation
+	HookBatch batch;
+	for (size_t i = 0; i < std::size(ExportHooks); i++)
+		batch.add(origs[i], ExportHooks[i].detour, *ExportHooks[i].hook);
+
+	const size_t numHooks = batch.size();
+	const size_t numApplied = batch.apply();
+	if (numApplied != numHooks)
+		spdlog::warn("nvngx: only {}/{} export hooks could be applied", numApplied, numHooks);
+
+	spdlog::info("nvngx: applied export hooks, waiting for game to call them...");
 }
 
 void unhook(HMODULE ngx_module)
 {
 	spdlog::debug("nvngx: begin unhook");
 
+	// Patched imports are left pointing at our hooks, since modules holding them may have been unloaded already
+	// GetProcAddress_Hook passes everything through once there's no module to redirect for
+	redirectModule.store(nullptr, std::memory_order_release);
+	importPatches.clear();
+
 	NVSDK_NGX_D3D11_EvaluateFeature_Hook.reset();
 	NVSDK_NGX_D3D11_Init_Hook.reset();
 	NVSDK_NGX_D3D11_Init_Ext_Hook.reset();
@@ -713,6 +883,12 @@ void unhook(HMODULE ngx_module)
 	NVSDK_NGX_Parameter_SetI_Hook.reset();
 	NVSDK_NGX_Parameter_SetUI_Hook.reset();
 	NVSDK_NGX_Parameter_GetUI_Hook.reset();
+	{
+		std::scoped_lock lock{paramHookMutex};
+		paramHooksApplied = false;
+		paramHookMode = ParamHookMode::Unset;
+		origParamVftable = nullptr; // objects using the shadow copy are freed along with _nvngx
+	}
 	NVSDK_NGX_D3D12_AllocateParameters_Hook.reset();
 	NVSDK_NGX_D3D12_GetCapabilityParameters_Hook.reset();
 	NVSDK_NGX_D3D12_GetParameters_Hook.reset();
@@ -771,7 +947,7 @@ void init_from_proxy()
 // Installs DllMain hook onto NVNGX
 void init(HMODULE ngx_module)
 {
-	if (proxy::is_wrapping_nvngx || settings.disableAllTweaks)
+	if (proxy::is_wrapping_nvngx || current_settings()->disableAllTweaks)
 		return;
 
 	// aren't wrapping nvngx, apply hooks to module
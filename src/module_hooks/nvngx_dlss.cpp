@@ -4,10 +4,11 @@
 #include <Windows.h>
 #include <winternl.h>
 
-#include <spdlog/spdlog.h>
 #include <Patterns.h>
 
 #include "DLSSTweaks.hpp"
+#include "HookLogic.hpp"
+#include "Log.hpp"
 
 namespace nvngx_dlss
 {
@@ -19,15 +20,16 @@ namespace nvngx_dlss
 		inline LSTATUS RegQueryValueExW_Hook(LSTATUS origRetValue, HKEY hKey, LPCWSTR lpValueName, LPDWORD lpReserved, LPDWORD lpType, LPBYTE lpData, LPDWORD lpcbData)
 		{
 			const LSTATUS ret = origRetValue;
-			if (settings.overrideDlssHud == 0 || _wcsicmp(lpValueName, L"ShowDlssIndicator") != 0)
+			const int overrideDlssHud = current_settings()->overrideDlssHud;
+			if (overrideDlssHud == 0 || _wcsicmp(lpValueName, L"ShowDlssIndicator") != 0)
 				return ret;
 
 			if (lpcbData && *lpcbData >= 4 && lpData)
 			{
 				DWORD* outData = (DWORD*)lpData;
-				if (settings.overrideDlssHud >= 1)
+				if (overrideDlssHud >= 1)
 					*outData = 0x400;
-				else if (settings.overrideDlssHud < 0)
+				else if (overrideDlssHud < 0)
 					*outData = 0;
 				return ERROR_SUCCESS;
 			}
@@ -38,11 +40,30 @@ namespace nvngx_dlss
 		inline uint32_t DLSS_GetIndicatorValue_Hook(uint32_t origRetValue, void* thisptr, uint32_t* OutValue)
 		{
 			const auto ret = origRetValue;
-			if (settings.overrideDlssHud == 0)
+			const int overrideDlssHud = current_settings()->overrideDlssHud;
+			if (overrideDlssHud == 0)
 				return ret;
-			*OutValue = settings.overrideDlssHud > 0 ? 0x400 : 0;
+			*OutValue = overrideDlssHud > 0 ? 0x400 : 0;
 			return ret;
 		}
+
+		// Converts an address into a pattern string matching its bytes, so we can search for vftable slots that point at it
+		inline std::string AddressPattern(const void* address)
+		{
+			constexpr char HexDigits[] = "0123456789abcdef";
+			const auto* bytes = (const uint8_t*)&address;
+
+			std::string pattern;
+			pattern.reserve(sizeof(address) * 3);
+			for (size_t i = 0; i < sizeof(address); i++)
+			{
+				if (i > 0)
+					pattern += ' ';
+				pattern += HexDigits[bytes[i] >> 4];
+				pattern += HexDigits[bytes[i] & 0xF];
+			}
+			return pattern;
+		}
 	};
 
 LSTATUS(__stdcall* RegQueryValueExW_Orig)(HKEY hKey, LPCWSTR lpValueName, LPDWORD lpReserved, LPDWORD lpType, LPBYTE lpData, LPDWORD lpcbData);
@@ -144,7 +165,8 @@ void CreateDlssInstance_PresetSelection(SafetyHookContext& ctx)
 	if (!dlssStruct)
 		return;
 
-	if (!settings.overrideQualityLevels)
+	const auto current = current_settings();
+	if (!current->overrideQualityLevels)
 		return;
 
 	int dlssWidth = *(int*)(dlssStruct + offsets.RenderResolution);
@@ -154,69 +176,41 @@ void CreateDlssInstance_PresetSelection(SafetyHookContext& ctx)
 
 	spdlog::debug("CreateDlssInstance_PresetSelection: DLSS res {}x{}, display {}x{}", dlssWidth, dlssHeight, displayWidth, displayHeight);
 
-	std::optional<unsigned int> presetValue;
-	presetValue.reset();
-
-	unsigned int presetDLAA = 0;
-	if (settings.qualities.contains(NVSDK_NGX_PerfQuality_Value_DLAA))
-		presetDLAA = settings.qualities[NVSDK_NGX_PerfQuality_Value_DLAA].preset;
-
-	for (const auto& [level, quality] : settings.qualities)
-	{
-		// Check that both height & width are within 1 pixel of each other either way
-		bool widthIsClose = abs(quality.currentResolution.first - dlssWidth) <= 1;
-		bool heightIsClose = abs(quality.currentResolution.second - dlssHeight) <= 1;
-		if (widthIsClose && heightIsClose)
-		{
-			if (quality.preset != NVSDK_NGX_DLSS_Hint_Render_Preset_Default)
-			{
-				spdlog::debug("CreateDlssInstance_PresetSelection: using preset {} for quality {} with resolution {}x{}", char('A' + quality.preset - 1), quality.name, quality.currentResolution.first, quality.currentResolution.second);
-				presetValue = quality.preset;
-			}
+	const auto selection = hook_logic::select_preset(current->qualities, dlss.reportedResolutions, { dlssWidth, dlssHeight }, { displayWidth, displayHeight });
 
-			break;
-		}
-	}
+	// No value override set, return now so DLSS will use whatever it was going to originally
+	if (selection.preset == NVSDK_NGX_DLSS_Hint_Render_Preset_Default)
+		return;
 
-	if (!presetValue.has_value())
-	{
-		// No match found for DLSS presets, check whether this could be DLAA
-		if (presetDLAA)
-		{
-			bool widthIsClose = abs(displayWidth - dlssWidth) <= 1;
-			bool heightIsClose = abs(displayHeight - dlssHeight) <= 1;
-			if (widthIsClose && heightIsClose)
-			{
-				spdlog::debug("CreateDlssInstance_PresetSelection: using preset {} for DLAA with resolution {}x{}", char('A' + presetDLAA - 1), displayWidth, displayHeight);
-				presetValue = presetDLAA;
-			}
-		}
+	if (selection.quality)
+		spdlog::debug("CreateDlssInstance_PresetSelection: using preset {} for quality {} with resolution {}x{}", char('A' + selection.preset - 1), selection.quality->name, selection.resolution.first, selection.resolution.second);
+	else
+		spdlog::debug("CreateDlssInstance_PresetSelection: using preset {} for DLAA with resolution {}x{}", char('A' + selection.preset - 1), displayWidth, displayHeight);
 
-		// If still no value override set, return now so DLSS will use whatever it was going to originally
-		if (!presetValue.has_value())
-			return;
-	}
+	const unsigned int presetValue = selection.preset;
 
 	if (CreateDlssInstance_PresetSelection_Register == 0x83) // release DLL, preset stored in rdx
-		ctx.rdx = *presetValue;
+		ctx.rdx = presetValue;
 	else if (CreateDlssInstance_PresetSelection_Register == 0x86) // dev DLL, preset stored in r15
-		ctx.r15 = *presetValue;
+		ctx.r15 = presetValue;
 	else if (CreateDlssInstance_PresetSelection_Register == 0x87)
 	{
 		if (CreateDlssInstance_PresetSelection_Offset == 0x11)
-			ctx.rcx = *presetValue; // 3.6.0 / 3.7.0, preset stored in rcx
+			ctx.rcx = presetValue; // 3.6.0 / 3.7.0, preset stored in rcx
 		else
-			ctx.rdx = *presetValue; // 3.1.30, preset stored in rdx
+			ctx.rdx = presetValue; // 3.1.30, preset stored in rdx
 	}
 }
 
 SafetyHookMid dlssIndicatorHudHook{};
 bool hook(HMODULE ngx_module)
 {
+	const auto current = current_settings();
+
 	// Search for & hook the function that overrides the DLSS presets with ones set by NV
 	// So that users can set custom DLSS presets without needing to override the whole app ID
 	// (if OverrideAppId is set there shouldn't be any need for this)
-	if (!settings.overrideAppId)
+	if (!current->overrideAppId)
 	{
 		auto pattern = hook::pattern(ngx_module, "41 0F 45 CE 48 89 7D ? 89 4D ? 48 8D 0D");
 		if (pattern.size())
@@ -326,11 +320,11 @@ bool hook(HMODULE ngx_module)
 
 	// If INI monitoring is enabled, or OverrideDlssHud is 2, we'll try setting up the realtime vftable hook
 	// allowing the HUD overlay to be toggled at runtime
-	if (indicatorValueCheck.size() && (!settings.disableIniMonitoring || settings.overrideDlssHud == 2))
+	if (indicatorValueCheck.size() && (!current->disableIniMonitoring || current->overrideDlssHud == 2))
 	{
-		if (!settings.disableIniMonitoring)
+		if (!current->disableIniMonitoring)
 			spdlog::debug("nvngx_dlss: applying hud hook via vftable hook...");
-		else if (settings.overrideDlssHud == 2)
+		else if (current->overrideDlssHud == 2)
 			spdlog::debug("nvngx_dlss: OverrideDlssHud == 2, applying hud hook via vftable hook...");
 
 		auto indicatorValueCheck_addr = indicatorValueCheck.get(0).get<void>();
@@ -339,23 +333,14 @@ bool hook(HMODULE ngx_module)
 		// Unfortunately it's not enough to just hook the function, HUD render code seems to have an optimization where it checks funcptr and inlines code if it matches
 		// So we also need to search for the address of the function, find vftable that holds it, and overwrite entry to point at our hook
 
-		// Ugly way of converting our address to a pattern string...
-		uint8_t* p = (uint8_t*)&indicatorValueCheck_addr;
-
-		std::stringstream ss;
-		ss << std::hex << std::setw(2) << std::setfill('0') << (int)p[0];
-		for (int i = 1; i < 8; ++i)
-			ss << " " << std::setw(2) << std::setfill('0') << (int)p[i];
-
-		auto pattern = ss.str();
+		auto pattern = shared::AddressPattern(indicatorValueCheck_addr);
 
+		// Gather up all the vftable slots first so they can be written with a single protection change per page
+		PatchSet vftablePatch;
 		auto indicatorValueCheckMemberVf = hook::pattern(ngx_module, pattern);
-		for (int i = 0; i < indicatorValueCheckMemberVf.size(); i++)
-		{
-			auto vfAddr = indicatorValueCheckMemberVf.get(i).get<uintptr_t>(0);
-			UnprotectMemory unprotect{ (uintptr_t)vfAddr, sizeof(uintptr_t) };
-			*vfAddr = (uintptr_t)&DLSS_GetIndicatorValue_Hook;
-		}
+		for (size_t i = 0; i < indicatorValueCheckMemberVf.size(); i++)
+			vftablePatch.add(indicatorValueCheckMemberVf.get(i).get<uintptr_t>(0), (uintptr_t)&DLSS_GetIndicatorValue_Hook);
+		vftablePatch.apply();
 
 		spdlog::info("nvngx_dlss: applied debug hud overlay hook via vftable hook");
 	}
@@ -398,7 +383,7 @@ BOOL APIENTRY hooked_dllmain(HMODULE hModule, int ul_reason_for_call, LPVOID lpR
 // Installs DllMain hook onto nvngx_dlss
 void init(HMODULE ngx_module)
 {
-	if (settings.disableAllTweaks)
+	if (current_settings()->disableAllTweaks)
 		return;
 
 	hook(ngx_module);
@@ -432,6 +417,8 @@ SafetyHookMid dlssIndicatorHudHook{};
 // NOTE: copy any changes to the nvngx_dlss::hook above!
 bool hook(HMODULE ngx_module)
 {
+	const auto current = current_settings();
+
 	// OverrideDlssHud hooks
 	// This pattern finds 2 matches in latest DLSS, but only 1 in older ones
 	// The one we're trying to find seems to always be first match
@@ -440,11 +427,11 @@ bool hook(HMODULE ngx_module)
 
 	// If INI monitoring is enabled, or OverrideDlssHud is 2, we'll try setting up the realtime vftable hook
 	// allowing the HUD overlay to be toggled at runtime
-	if (indicatorValueCheck.size() && (!settings.disableIniMonitoring || settings.overrideDlssHud == 2))
+	if (indicatorValueCheck.size() && (!current->disableIniMonitoring || current->overrideDlssHud == 2))
 	{
-		if (!settings.disableIniMonitoring)
+		if (!current->disableIniMonitoring)
 			spdlog::debug("nvngx_dlssd: applying hud hook via vftable hook...");
-		else if (settings.overrideDlssHud == 2)
+		else if (current->overrideDlssHud == 2)
 			spdlog::debug("nvngx_dlssd: OverrideDlssHud == 2, applying hud hook via vftable hook...");
 
 		auto indicatorValueCheck_addr = indicatorValueCheck.get(0).get<void>();
@@ -453,23 +440,14 @@ bool hook(HMODULE ngx_module)
 		// Unfortunately it's not enough to just hook the function, HUD render code seems to have an optimization where it checks funcptr and inlines code if it matches
 		// So we also need to search for the address of the function, find vftable that holds it, and overwrite entry to point at our hook
 
-		// Ugly way of converting our address to a pattern string...
-		auto* p = (uint8_t*)&indicatorValueCheck_addr;
-
-		std::stringstream ss;
-		ss << std::hex << std::setw(2) << std::setfill('0') << (int)p[0];
-		for (int i = 1; i < 8; ++i)
-			ss << " " << std::setw(2) << std::setfill('0') << (int)p[i];
-
-		auto pattern = ss.str();
+		auto pattern = nvngx_dlss::shared::AddressPattern(indicatorValueCheck_addr);
 
+		// Gather up all the vftable slots first so they can be written with a single protection change per page
+		PatchSet vftablePatch;
 		auto indicatorValueCheckMemberVf = hook::pattern(ngx_module, pattern);
-		for (int i = 0; i < indicatorValueCheckMemberVf.size(); i++)
-		{
-			auto vfAddr = indicatorValueCheckMemberVf.get(i).get<uintptr_t>(0);
-			UnprotectMemory unprotect{ (uintptr_t)vfAddr, sizeof(uintptr_t) };
-			*vfAddr = (uintptr_t)&DLSS_GetIndicatorValue_Hook;
-		}
+		for (size_t i = 0; i < indicatorValueCheckMemberVf.size(); i++)
+			vftablePatch.add(indicatorValueCheckMemberVf.get(i).get<uintptr_t>(0), (uintptr_t)&DLSS_GetIndicatorValue_Hook);
+		vftablePatch.apply();
 
 		spdlog::info("nvngx_dlssd: applied debug hud overlay hook via vftable hook");
 	}
@@ -512,7 +490,7 @@ BOOL APIENTRY hooked_dllmain(HMODULE hModule, int ul_reason_for_call, LPVOID lpR
 // Installs DllMain hook onto nvngx_dlssd
 void init(HMODULE ngx_module)
 {
-	if (settings.disableAllTweaks)
+	if (current_settings()->disableAllTweaks)
 		return;
 
 	hook(ngx_module);
@@ -4,16 +4,33 @@
 #include <Windows.h>
 #include <winternl.h>
 
-#include <spdlog/spdlog.h>
 #include <Patterns.h>
 
 #include "DLSSTweaks.hpp"
+#include "Log.hpp"
 
 namespace nvngx_dlssg
 {
 std::mutex module_handle_mtx;
 HMODULE module_handle = nullptr;
 
+// Watermark text patches found inside the module, original bytes are kept so the patch can be toggled on INI reload without rescanning
+PatchSet watermark_patch;
+
+// Searches for the watermark text included in certain DLSSG builds, and queues up patches to null it
+void find_watermark(HMODULE module)
+{
+	watermark_patch.clear();
+
+	auto pattern = hook::pattern(module,
+		"56 49 44 49 41 20 43 4F 4E 46 49 44 45 4E 54 49 41 4C 20 2D 20");
+
+	for (size_t i = 0; i < pattern.size(); i++)
+		watermark_patch.add(pattern.get(i).get<char>(-1), char(0));
+
+	spdlog::debug("nvngx_dlssg: found {} watermark strings inside module", watermark_patch.size());
+}
+
 // Currently just nulls the watermark text included in certain DLSSG builds
 void settings_changed()
 {
@@ -22,34 +39,22 @@ void settings_changed()
 	if (!module_handle)
 		return;
 
-	const char patch = settings.disableDevWatermark ? 0 : 0x4E;
-
-	// Search for DLSSG watermark text and null it if found
-	auto pattern = hook::pattern(module_handle,
-		"56 49 44 49 41 20 43 4F 4E 46 49 44 45 4E 54 49 41 4C 20 2D 20");
-
-	size_t numWatermarkStrings = pattern.size();
-	if (!numWatermarkStrings)
-	{
-		spdlog::warn("nvngx_dlssg: DisableDevWatermark failed, couldn't locate watermark string inside module");
+	const bool disableDevWatermark = current_settings()->disableDevWatermark;
+	if (disableDevWatermark == watermark_patch.is_applied())
 		return;
-	}
 
-	int changed = 0;
-	for (size_t i = 0; i < numWatermarkStrings; i++)
+	if (watermark_patch.empty())
 	{
-		char* result = pattern.get(i).get<char>(-1);
-
-		if (result[0] != patch)
-		{
-			UnprotectMemory unprotect{ (uintptr_t)result, 1 };
-			*result = patch;
-			changed++;
-		}
+		if (disableDevWatermark)
+			spdlog::warn("nvngx_dlssg: DisableDevWatermark failed, couldn't locate watermark string inside module");
+		return;
 	}
 
-	if (changed)
-		spdlog::info("nvngx_dlssg: DisableDevWatermark patch {} ({}/{} strings patched)", settings.disableDevWatermark ? "applied" : "removed", changed, numWatermarkStrings);
+	const bool success = disableDevWatermark ? watermark_patch.apply() : watermark_patch.revert();
+	if (success)
+		spdlog::info("nvngx_dlssg: DisableDevWatermark patch {} ({} strings patched)", disableDevWatermark ? "applied" : "removed", watermark_patch.size());
+	else
+		spdlog::error("nvngx_dlssg: DisableDevWatermark patch failed to {}", disableDevWatermark ? "apply" : "remove");
 }
 	
 SafetyHookInline dllmain;
@@ -67,6 +72,7 @@ BOOL APIENTRY hooked_dllmain(HMODULE hModule, int ul_reason_for_call, LPVOID lpR
 	{
 		std::scoped_lock lock{module_handle_mtx};
 		module_handle = nullptr;
+		watermark_patch.clear(); // module is going away, nothing left to revert
 		dllmain.reset();
 	}
 
@@ -75,12 +81,13 @@ BOOL APIENTRY hooked_dllmain(HMODULE hModule, int ul_reason_for_call, LPVOID lpR
 
 void init(HMODULE ngx_module)
 {
-	if (settings.disableAllTweaks)
+	if (current_settings()->disableAllTweaks)
 		return;
 
 	{
 		std::scoped_lock lock{ module_handle_mtx };
 		module_handle = ngx_module;
+		find_watermark(ngx_module);
 	}
 	settings_changed();
 
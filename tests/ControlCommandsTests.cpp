@@ -0,0 +1,122 @@
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ControlCommands.hpp"
+#include "IniParser.hpp"
+#include "Tests.hpp"
+
+namespace
+{
+// Two int settings & one bool, values only change through set() so tests can see whether a batch got applied
+class FakeTarget final : public control::CommandTarget
+{
+public:
+	bool get(std::string_view name, std::string& value) const override
+	{
+		const auto it = values.find(std::string(name));
+		if (it == values.end())
+			return false;
+		value = it->second;
+		return true;
+	}
+
+	std::vector<std::pair<std::string, std::string>> list() const override
+	{
+		return { values.begin(), values.end() };
+	}
+
+	Check check(std::string_view name, std::string_view value) const override
+	{
+		if (!values.contains(std::string(name)))
+			return Check::UnknownSetting;
+
+		if (name == "DLSS.ForceDLAA")
+		{
+			bool result;
+			return ini::parse_bool(value, result) ? Check::Valid : Check::InvalidValue;
+		}
+		int result;
+		return ini::parse_int(value, result) ? Check::Valid : Check::InvalidValue;
+	}
+
+	void set(const std::vector<std::pair<std::string_view, std::string_view>>& batch) override
+	{
+		numSets++;
+		for (const auto& [name, value] : batch)
+			values[std::string(name)] = value;
+	}
+
+	bool reload() override
+	{
+		numReloads++;
+		return reloadResult;
+	}
+
+	std::string stats() const override
+	{
+		return "wakeups=1";
+	}
+
+	std::map<std::string, std::string> values = {
+		{ "Compatibility.ResolutionOffset", "0" },
+		{ "DLSS.ForceDLAA", "false" },
+		{ "DLSS.OverrideHDR", "0" },
+	};
+	int numSets = 0;
+	int numReloads = 0;
+	bool reloadResult = true;
+};
+};
+
+TEST(control_get)
+{
+	FakeTarget target;
+	CHECK(control::execute("get DLSS.OverrideHDR", target) == "ok 0");
+	CHECK(control::execute("  GET   DLSS.ForceDLAA  ", target) == "ok false");
+	CHECK(control::execute("get DLSS.Missing", target) == "err unknown setting DLSS.Missing");
+	CHECK(control::execute("get", target) == "err unknown setting ");
+}
+
+TEST(control_set_applies_batch_together)
+{
+	FakeTarget target;
+	CHECK(control::execute("set DLSS.OverrideHDR=1 DLSS.ForceDLAA=true", target) == "ok");
+	CHECK(target.numSets == 1);
+	CHECK(target.values["DLSS.OverrideHDR"] == "1");
+	CHECK(target.values["DLSS.ForceDLAA"] == "true");
+}
+
+TEST(control_set_rejects_whole_batch)
+{
+	FakeTarget target;
+
+	// Valid values before & after the bad one mustn't be applied either
+	CHECK(control::execute("set DLSS.OverrideHDR=1 DLSS.ForceDLAA=maybe Compatibility.ResolutionOffset=2", target) == "err invalid value for DLSS.ForceDLAA: maybe");
+	CHECK(control::execute("set DLSS.OverrideHDR=1 DLSS.Missing=1", target) == "err unknown setting DLSS.Missing");
+	CHECK(control::execute("set DLSS.OverrideHDR=1 DLSS.ForceDLAA", target) == "err expected Section.Key=value, got DLSS.ForceDLAA");
+	CHECK(control::execute("set", target) == "err usage: set Section.Key=value [...]");
+
+	CHECK(target.numSets == 0);
+	CHECK(target.values["DLSS.OverrideHDR"] == "0");
+	CHECK(target.values["Compatibility.ResolutionOffset"] == "0");
+}
+
+TEST(control_list)
+{
+	FakeTarget target;
+	CHECK(control::execute("list", target) == "ok\nCompatibility.ResolutionOffset=0\nDLSS.ForceDLAA=false\nDLSS.OverrideHDR=0");
+}
+
+TEST(control_reload_stats_unknown)
+{
+	FakeTarget target;
+	CHECK(control::execute("reload", target) == "ok");
+	target.reloadResult = false;
+	CHECK(control::execute("Reload", target) == "err failed to read INIs");
+	CHECK(target.numReloads == 2);
+
+	CHECK(control::execute("stats", target) == "ok wakeups=1");
+	CHECK(control::execute("frobnicate DLSS.ForceDLAA", target) == "err unknown command frobnicate");
+	CHECK(control::execute("", target) == "err unknown command ");
+}
@@ -0,0 +1,229 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Builds PE files in memory for the pe::Image tests & benchmarks, so they don't need a Windows DLL checked in
+// Output is a single-section image holding the export & import directories, laid out the same way a linker would:
+// export names sorted byte-wise, forwarder strings inside the export directory, lookup table & IAT both holding the import names
+namespace tests
+{
+class PeBuilder
+{
+public:
+	static constexpr uint32_t SectionRva = 0x1000;
+	static constexpr uint32_t HeadersSize = 0x200;
+
+	explicit PeBuilder(bool is64 = true) : m_is64(is64) {}
+
+	void add_export(std::string name, uint32_t rva)
+	{
+		m_exports.push_back({ std::move(name), rva, {} });
+	}
+
+	// Forwarded exports point at a "module.function" string instead of code
+	void add_forwarder(std::string name, std::string target)
+	{
+		m_exports.push_back({ std::move(name), 0, std::move(target) });
+	}
+
+	void add_import(std::string module, std::vector<std::string> functions)
+	{
+		m_imports.push_back({ std::move(module), std::move(functions) });
+	}
+
+	// RVA of the IAT entry for module!function in the last build(), 0 if it wasn't added
+	uint32_t iat_rva(const std::string& module, const std::string& function) const
+	{
+		for (const auto& entry : m_iatRvas)
+			if (entry.first == module + "!" + function)
+				return entry.second;
+		return 0;
+	}
+
+	std::vector<uint8_t> build()
+	{
+		std::vector<uint8_t> section;
+		m_iatRvas.clear();
+
+		uint32_t exportRva = 0, exportSize = 0;
+		if (!m_exports.empty())
+		{
+			exportRva = SectionRva;
+			build_exports(section);
+			exportSize = uint32_t(section.size());
+		}
+
+		uint32_t importRva = 0, importSize = 0;
+		if (!m_imports.empty())
+		{
+			align(section, 8);
+			importRva = rva(section);
+			build_imports(section);
+			importSize = uint32_t(SectionRva + section.size() - importRva);
+		}
+		align(section, 0x200);
+
+		const size_t optionalHeaderSize = (m_is64 ? 112 : 96) + 16 * 8;
+		std::vector<uint8_t> file(HeadersSize);
+		put<uint16_t>(file, 0, 0x5A4D); // MZ
+		put<uint32_t>(file, 0x3C, 0x40);
+		put<uint32_t>(file, 0x40, 0x00004550); // PE\0\0
+
+		const size_t fileHeader = 0x44;
+		put<uint16_t>(file, fileHeader, m_is64 ? 0x8664 : 0x14C);
+		put<uint16_t>(file, fileHeader + 2, 1);
+		put<uint16_t>(file, fileHeader + 16, uint16_t(optionalHeaderSize));
+
+		const size_t optionalHeader = fileHeader + 20;
+		const size_t dirs = optionalHeader + (m_is64 ? 108 : 92);
+		put<uint16_t>(file, optionalHeader, m_is64 ? 0x20B : 0x10B);
+		put<uint32_t>(file, optionalHeader + 56, uint32_t(SectionRva + section.size()));
+		put<uint32_t>(file, optionalHeader + 60, HeadersSize);
+		put<uint32_t>(file, dirs, 16);
+		put<uint32_t>(file, dirs + 4, exportRva);
+		put<uint32_t>(file, dirs + 8, exportSize);
+		put<uint32_t>(file, dirs + 12, importRva);
+		put<uint32_t>(file, dirs + 16, importSize);
+
+		const size_t sectionHeader = optionalHeader + optionalHeaderSize;
+		std::memcpy(&file[sectionHeader], ".rdata", 6);
+		put<uint32_t>(file, sectionHeader + 8, uint32_t(section.size()));
+		put<uint32_t>(file, sectionHeader + 12, SectionRva);
+		put<uint32_t>(file, sectionHeader + 16, uint32_t(section.size()));
+		put<uint32_t>(file, sectionHeader + 20, HeadersSize);
+
+		file.insert(file.end(), section.begin(), section.end());
+		return file;
+	}
+
+	// Lays a built file out the way the loader would map it, section at its RVA, for pe::Image::parse_mapped
+	static std::vector<uint8_t> map(const std::vector<uint8_t>& file)
+	{
+		std::vector<uint8_t> image(SectionRva + file.size() - HeadersSize);
+		std::copy(file.begin(), file.begin() + HeadersSize, image.begin());
+		std::copy(file.begin() + HeadersSize, file.end(), image.begin() + SectionRva);
+		return image;
+	}
+
+private:
+	struct Export
+	{
+		std::string name;
+		uint32_t rva;
+		std::string forwarder;
+	};
+
+	struct Import
+	{
+		std::string module;
+		std::vector<std::string> functions;
+	};
+
+	template <typename T>
+	static void put(std::vector<uint8_t>& data, size_t offset, T value)
+	{
+		std::memcpy(&data[offset], &value, sizeof(T));
+	}
+
+	static uint32_t rva(const std::vector<uint8_t>& section) { return uint32_t(SectionRva + section.size()); }
+
+	static void align(std::vector<uint8_t>& section, size_t alignment)
+	{
+		section.resize((section.size() + alignment - 1) & ~(alignment - 1));
+	}
+
+	static uint32_t put_string(std::vector<uint8_t>& section, const std::string& str)
+	{
+		const uint32_t result = rva(section);
+		section.insert(section.end(), str.begin(), str.end());
+		section.push_back(0);
+		return result;
+	}
+
+	void build_exports(std::vector<uint8_t>& section) const
+	{
+		// Ordinals follow the order exports were added in, only the name table gets sorted
+		std::vector<size_t> byName(m_exports.size());
+		for (size_t i = 0; i < byName.size(); i++)
+			byName[i] = i;
+		std::sort(byName.begin(), byName.end(), [this](size_t a, size_t b) { return m_exports[a].name < m_exports[b].name; });
+
+		const uint32_t numExports = uint32_t(m_exports.size());
+		const size_t functions = 40;
+		const size_t names = functions + numExports * 4;
+		const size_t ordinals = names + numExports * 4;
+		section.resize(ordinals + numExports * 2);
+
+		put<uint32_t>(section, 16, 1); // ordinal base
+		put<uint32_t>(section, 20, numExports);
+		put<uint32_t>(section, 24, numExports);
+		put<uint32_t>(section, 28, uint32_t(SectionRva + functions));
+		put<uint32_t>(section, 32, uint32_t(SectionRva + names));
+		put<uint32_t>(section, 36, uint32_t(SectionRva + ordinals));
+		put<uint32_t>(section, 12, put_string(section, "test.dll"));
+
+		for (uint32_t i = 0; i < numExports; i++)
+		{
+			const auto& entry = m_exports[byName[i]];
+			put<uint32_t>(section, names + i * 4, put_string(section, entry.name));
+			put<uint16_t>(section, ordinals + i * 2, uint16_t(byName[i]));
+		}
+
+		for (uint32_t i = 0; i < numExports; i++)
+		{
+			const auto& entry = m_exports[i];
+			const uint32_t target = entry.forwarder.empty() ? entry.rva : put_string(section, entry.forwarder);
+			put<uint32_t>(section, functions + i * 4, target);
+		}
+	}
+
+	void build_imports(std::vector<uint8_t>& section)
+	{
+		const size_t thunkSize = m_is64 ? 8 : 4;
+		const size_t descriptors = section.size();
+		section.resize(descriptors + (m_imports.size() + 1) * 20);
+
+		for (size_t i = 0; i < m_imports.size(); i++)
+		{
+			const auto& entry = m_imports[i];
+			const size_t descriptor = descriptors + i * 20;
+			const size_t tableSize = (entry.functions.size() + 1) * thunkSize;
+
+			align(section, 8);
+			const size_t lookup = section.size();
+			const size_t iat = lookup + tableSize;
+			section.resize(iat + tableSize);
+			put<uint32_t>(section, descriptor, uint32_t(SectionRva + lookup));
+			put<uint32_t>(section, descriptor + 16, uint32_t(SectionRva + iat));
+			put<uint32_t>(section, descriptor + 12, put_string(section, entry.module));
+
+			for (size_t j = 0; j < entry.functions.size(); j++)
+			{
+				// IMAGE_IMPORT_BY_NAME: 2-byte hint, then the name
+				align(section, 2);
+				const uint32_t hintName = rva(section);
+				section.insert(section.end(), 2, 0);
+				put_string(section, entry.functions[j]);
+
+				for (const size_t table : { lookup, iat })
+				{
+					if (m_is64)
+						put<uint64_t>(section, table + j * thunkSize, hintName);
+					else
+						put<uint32_t>(section, table + j * thunkSize, hintName);
+				}
+				m_iatRvas.emplace_back(entry.module + "!" + entry.functions[j], uint32_t(SectionRva + iat + j * thunkSize));
+			}
+		}
+	}
+
+	bool m_is64;
+	std::vector<Export> m_exports;
+	std::vector<Import> m_imports;
+	std::vector<std::pair<std::string, uint32_t>> m_iatRvas;
+};
+};
@@ -0,0 +1,174 @@
+#include <string>
+#include <vector>
+
+#include "PeBuilder.hpp"
+#include "PeImage.hpp"
+#include "Tests.hpp"
+
+namespace
+{
+std::vector<uint8_t> WinmmLikeImage(tests::PeBuilder& builder)
+{
+	builder.add_export("timeGetTime", 0x5010);
+	builder.add_export("PlaySoundW", 0x5020);
+	builder.add_export("mciSendStringA", 0x5030);
+	builder.add_forwarder("timeBeginPeriod", "KERNEL32.timeBeginPeriod");
+	builder.add_export("waveOutOpen", 0x5040);
+	builder.add_import("KERNEL32.dll", { "GetProcAddress", "LoadLibraryW", "Sleep" });
+	builder.add_import("USER32.dll", { "MessageBoxW" });
+	return builder.build();
+}
+};
+
+TEST(pe_exports_by_name)
+{
+	for (const bool is64 : { true, false })
+	{
+		tests::PeBuilder builder(is64);
+		const auto file = WinmmLikeImage(builder);
+
+		pe::Image image;
+		CHECK(image.parse_file(file.data(), file.size()));
+		CHECK(image.is_64bit() == is64);
+		CHECK(image.num_exports() == 5);
+
+		CHECK(image.find_export("timeGetTime").rva == 0x5010);
+		CHECK(!image.find_export("timeGetTime").forwarded);
+		CHECK(image.find_export("waveOutOpen").rva == 0x5040);
+		CHECK(!image.find_export("timegettime"));
+		CHECK(!image.find_export("timeGetTim"));
+		CHECK(!image.find_export(""));
+
+		// Name table is byte-wise sorted, so uppercase names come before lowercase ones
+		CHECK(image.export_name(0) == "PlaySoundW");
+		CHECK(image.export_name(4) == "waveOutOpen");
+		CHECK(image.export_name(5).empty());
+		CHECK(image.export_at(0).rva == 0x5020);
+	}
+}
+
+TEST(pe_exports_without_hash_table)
+{
+	// More names than the hash table takes, lookups binary search the name table instead
+	tests::PeBuilder builder;
+	const size_t numExports = pe::Image::ExportHashSize;
+	for (size_t i = 0; i < numExports; i++)
+		builder.add_export("Export" + std::to_string(i), uint32_t(0x10000 + i * 16));
+	const auto file = builder.build();
+
+	pe::Image image;
+	CHECK(image.parse_file(file.data(), file.size()));
+	CHECK(image.num_exports() == numExports);
+	CHECK(image.find_export("Export0").rva == 0x10000);
+	CHECK(image.find_export("Export1234").rva == 0x10000 + 1234 * 16);
+	CHECK(image.find_export("Export4095").rva == 0x10000 + 4095 * 16);
+	CHECK(!image.find_export("Export4096"));
+	CHECK(!image.find_export("Export"));
+	CHECK(!image.find_export("export1"));
+}
+
+TEST(pe_forwarded_exports)
+{
+	tests::PeBuilder builder;
+	const auto file = WinmmLikeImage(builder);
+
+	pe::Image image;
+	CHECK(image.parse_file(file.data(), file.size()));
+
+	const auto forwarded = image.find_export("timeBeginPeriod");
+	CHECK(forwarded.forwarded);
+
+	const std::string_view target = "KERNEL32.timeBeginPeriod";
+	const auto* str = reinterpret_cast<const char*>(image.rva_to_ptr(forwarded.rva, target.size() + 1));
+	CHECK(str && std::string_view(str) == target);
+}
+
+TEST(pe_find_import)
+{
+	for (const bool is64 : { true, false })
+	{
+		tests::PeBuilder builder(is64);
+		const auto file = WinmmLikeImage(builder);
+
+		pe::Image image;
+		CHECK(image.parse_file(file.data(), file.size()));
+		CHECK(image.num_imports() == 2);
+
+		CHECK(image.find_import("KERNEL32.dll", "GetProcAddress") == builder.iat_rva("KERNEL32.dll", "GetProcAddress"));
+		CHECK(image.find_import("kernel32.DLL", "Sleep") == builder.iat_rva("KERNEL32.dll", "Sleep"));
+		CHECK(image.find_import("USER32.dll", "MessageBoxW") == builder.iat_rva("USER32.dll", "MessageBoxW"));
+		CHECK(image.find_import("KERNEL32.dll", "Sleep") == image.find_import("KERNEL32.dll", "GetProcAddress") + (is64 ? 16 : 8));
+
+		// Function names are case-sensitive, & have to come from the module asked for
+		CHECK(image.find_import("KERNEL32.dll", "sleep") == 0);
+		CHECK(image.find_import("USER32.dll", "Sleep") == 0);
+		CHECK(image.find_import("GDI32.dll", "Sleep") == 0);
+	}
+}
+
+TEST(pe_rejects_corrupt_headers)
+{
+	tests::PeBuilder builder;
+	const auto file = WinmmLikeImage(builder);
+
+	pe::Image image;
+	CHECK(!image.parse_file(nullptr, 0));
+	CHECK(!image.parse_file(file.data(), 0x3F));
+
+	auto corrupt = file;
+	corrupt[0] = 'X'; // MZ
+	CHECK(!image.parse_file(corrupt.data(), corrupt.size()));
+
+	corrupt = file;
+	corrupt[0x41] = 'X'; // PE\0\0
+	CHECK(!image.parse_file(corrupt.data(), corrupt.size()));
+
+	corrupt = file;
+	corrupt[0x3C] = 0xF0; // NT headers offset past the end
+	corrupt[0x3D] = 0xFF;
+	CHECK(!image.parse_file(corrupt.data(), corrupt.size()));
+
+	corrupt = file;
+	corrupt[0x58] = 0; // optional header magic
+	CHECK(!image.parse_file(corrupt.data(), corrupt.size()));
+
+	// Export name count way past the end of the section, headers are fine but the export table gets ignored
+	corrupt = file;
+	corrupt[tests::PeBuilder::HeadersSize + 24 + 2] = 0x7F;
+	CHECK(image.parse_file(corrupt.data(), corrupt.size()));
+	CHECK(image.num_exports() == 0);
+	CHECK(!image.find_export("timeGetTime"));
+	CHECK(image.find_import("KERNEL32.dll", "Sleep") == builder.iat_rva("KERNEL32.dll", "Sleep"));
+}
+
+TEST(pe_truncated_files)
+{
+	tests::PeBuilder builder;
+	const auto file = WinmmLikeImage(builder);
+
+	// Every possible truncation either fails to parse or only finds what's still within the data, never reads past it
+	// (copied so each truncated buffer ends exactly where a real short read would)
+	for (size_t size = 0; size < file.size(); size++)
+	{
+		const std::vector<uint8_t> truncated(file.begin(), file.begin() + size);
+
+		pe::Image image;
+		if (!image.parse_file(truncated.data(), truncated.size()))
+		{
+			CHECK(size < tests::PeBuilder::HeadersSize);
+			continue;
+		}
+
+		const auto found = image.find_export("waveOutOpen");
+		CHECK(!found || found.rva == 0x5040);
+		for (size_t i = 0; i < image.num_exports(); i++)
+			image.export_name(i);
+
+		const uint32_t iat = image.find_import("USER32.dll", "MessageBoxW");
+		CHECK(iat == 0 || iat == builder.iat_rva("USER32.dll", "MessageBoxW"));
+	}
+
+	pe::Image image;
+	CHECK(image.parse_file(file.data(), file.size()));
+	CHECK(image.find_export("waveOutOpen").rva == 0x5040);
+}
@@ -0,0 +1,93 @@
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "Prefetch.hpp"
+#include "Tests.hpp"
+
+namespace
+{
+// Temp folder holding a few files of known contents, removed again once the test is done
+class TempFiles
+{
+public:
+	TempFiles()
+	{
+		m_dir = std::filesystem::temp_directory_path() / ("dlsstweaks_tests_" + std::to_string(uintptr_t(this)));
+		std::filesystem::create_directories(m_dir);
+	}
+
+	~TempFiles()
+	{
+		std::error_code ec;
+		std::filesystem::remove_all(m_dir, ec);
+	}
+
+	std::filesystem::path add(const std::string& name, const std::string& contents)
+	{
+		const auto path = m_dir / name;
+		if (FILE* file = fopen(path.string().c_str(), "wb"))
+		{
+			fwrite(contents.data(), 1, contents.size(), file);
+			fclose(file);
+		}
+		return path;
+	}
+
+	std::filesystem::path path(const std::string& name) const { return m_dir / name; }
+
+private:
+	std::filesystem::path m_dir;
+};
+
+// Varying bytes, so a read that skipped or repeated a chunk wouldn't match
+std::string Contents(size_t size)
+{
+	std::string contents(size, '\0');
+	for (size_t i = 0; i < size; i++)
+		contents[i] = char((i * 31 + i / 4096) & 0xFF);
+	return contents;
+}
+};
+
+TEST(prefetch_reads_whole_file)
+{
+	TempFiles files;
+	// Bigger than the 1MB chunk warm_files reads with, & not a multiple of it
+	const auto contents = Contents(2 * 1024 * 1024 + 12345);
+	const auto path = files.add("large.dll", contents);
+
+	prefetch::SequentialFile file(path);
+	CHECK(file.is_open());
+	CHECK(file.size() == contents.size());
+
+	std::string read;
+	std::vector<char> buffer(64 * 1024 + 7);
+	while (size_t bytesRead = file.read(buffer.data(), buffer.size()))
+		read.append(buffer.data(), bytesRead);
+	CHECK(read == contents);
+	CHECK(file.read(buffer.data(), buffer.size()) == 0);
+
+	file.close();
+	CHECK(!file.is_open());
+	CHECK(file.read(buffer.data(), buffer.size()) == 0);
+}
+
+TEST(prefetch_warm_files)
+{
+	TempFiles files;
+	const std::vector<std::filesystem::path> paths = {
+		files.add("a.dll", Contents(3 * 1024 * 1024)),
+		files.path("missing.dll"),
+		files.add("empty.dll", ""),
+		files.add("b.dll", Contents(4321)),
+	};
+
+	const auto stats = prefetch::warm_files(paths);
+	CHECK(stats.files == 3);
+	CHECK(stats.bytes == 3 * 1024 * 1024 + 4321);
+
+	CHECK(prefetch::warm_files({}).files == 0);
+	CHECK(!prefetch::SequentialFile(files.path("missing.dll")).is_open());
+}
@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "PeBuilder.hpp"
+#include "PeImage.hpp"
+#include "Tests.hpp"
+
+// Just enough of Proxy.hpp for the generated tables to compile, the stubs in them are never called
+using FARPROC = void (*)();
+namespace proxy
+{
+struct ExportSlot
+{
+	const char* name;
+	FARPROC* slot;
+};
+};
+#define PLUGIN_API [[maybe_unused]] static
+
+namespace winmm
+{
+#include "ProxyWinmm.inc"
+};
+
+namespace nvngx
+{
+#include "ProxyNvngx.inc"
+};
+
+namespace
+{
+// Plain unsigned byte order, which is what the linker sorts the export name table by
+bool ByteLess(std::string_view a, std::string_view b)
+{
+	return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(),
+		[](char x, char y) { return (unsigned char)x < (unsigned char)y; });
+}
+
+template <size_t N>
+std::vector<std::string_view> Names(const proxy::ExportSlot (&table)[N])
+{
+	std::vector<std::string_view> names;
+	for (const auto& entry : table)
+		names.push_back(entry.name);
+	return names;
+}
+
+constexpr uint32_t ExportRva(size_t index)
+{
+	return uint32_t(0x20000 + index * 16);
+}
+
+// Runs the same merge-join as proxy::resolve_exports against a mapped image holding every name in the table except skipped,
+// plus names the table doesn't have mixed in between, & checks each name ended up with its own export
+void CheckJoin(const std::vector<std::string_view>& names, std::string_view skipped, std::string_view forwarded)
+{
+	tests::PeBuilder builder;
+	for (size_t i = names.size(); i-- > 0;)
+	{
+		if (names[i] == skipped)
+			continue;
+		if (names[i] == forwarded)
+			builder.add_forwarder(std::string(names[i]), "KERNEL32." + std::string(names[i]));
+		else
+			builder.add_export(std::string(names[i]), ExportRva(i));
+	}
+
+	// Sort before, between & after the table's names, including lowercase/underscore/non-ASCII names that signed char comparisons would misplace
+	for (const char* extra : { "AAA_First", "PlaySoundX", "_internal", "aux_Unused", "mmioZ", "zzz_Last", "\xE9vent" })
+		builder.add_export(extra, 0x10);
+
+	const auto image = tests::PeBuilder::map(builder.build());
+	pe::Image pe;
+	CHECK(pe.parse_mapped(image.data()));
+
+	std::vector<uint32_t> resolved(names.size());
+	std::vector<bool> wasForwarded(names.size());
+	pe.join_exports(names.size(), [&names](size_t i) { return names[i]; }, [&](size_t i, pe::Image::Export exp) {
+		resolved[i] = exp.rva;
+		wasForwarded[i] = exp.forwarded;
+	});
+
+	for (size_t i = 0; i < names.size(); i++)
+	{
+		if (names[i] == skipped)
+			CHECK(resolved[i] == 0);
+		else if (names[i] == forwarded)
+			CHECK(wasForwarded[i] && resolved[i] != 0);
+		else
+			CHECK(!wasForwarded[i] && resolved[i] == ExportRva(i));
+	}
+}
+};
+
+TEST(proxy_tables_sorted_bytewise)
+{
+	for (const auto& names : { Names(winmm::WinmmExports), Names(nvngx::NvngxExports) })
+	{
+		CHECK(!names.empty());
+		for (size_t i = 1; i < names.size(); i++)
+		{
+			// list(SORT ... CASE SENSITIVE) has to give the same order as the PE's name table, & the same as string_view::compare
+			CHECK(ByteLess(names[i - 1], names[i]));
+			CHECK(names[i - 1].compare(names[i]) < 0);
+		}
+	}
+
+	// Non-ASCII bytes sort after ASCII ones even where char is signed
+	CHECK(std::string_view("\xE9vent").compare("zzz") > 0);
+}
+
+TEST(proxy_join_winmm)
+{
+	const auto names = Names(winmm::WinmmExports);
+	CheckJoin(names, "", "");
+	CheckJoin(names, names.front(), names.back());
+	CheckJoin(names, "PlaySoundW", "timeGetTime");
+	CheckJoin(names, names.back(), names[names.size() / 2]);
+}
+
+TEST(proxy_join_nvngx)
+{
+	const auto names = Names(nvngx::NvngxExports);
+	CheckJoin(names, "", "");
+	CheckJoin(names, "NVSDK_NGX_D3D12_Init", "NVSDK_NGX_D3D11_Init");
+}
@@ -0,0 +1,69 @@
+// Runs every registered test, or only those whose name contains the filter given on the command line
+//
+// usage: dlsstweaks_tests [filter]
+
+#include <cstdio>
+#include <string_view>
+#include <vector>
+
+#include "Tests.hpp"
+
+namespace tests
+{
+namespace
+{
+struct TestCase
+{
+	std::string_view name;
+	TestFn fn;
+};
+
+// Function-local so registration from other translation units' static init doesn't depend on init order
+std::vector<TestCase>& registry()
+{
+	static std::vector<TestCase> cases;
+	return cases;
+}
+
+int currentFailures = 0;
+};
+
+Registrar::Registrar(std::string_view name, TestFn fn)
+{
+	registry().push_back({ name, fn });
+}
+
+void report_failure(const char* file, int line, const char* expression)
+{
+	fprintf(stderr, "  %s:%d: CHECK(%s) failed\n", file, line, expression);
+	currentFailures++;
+}
+};
+
+int main(int argc, char** argv)
+{
+	const std::string_view filter = argc > 1 ? argv[1] : "";
+
+	int numRun = 0;
+	int numFailed = 0;
+	for (const auto& test : tests::registry())
+	{
+		if (!filter.empty() && test.name.find(filter) == std::string_view::npos)
+			continue;
+
+		tests::currentFailures = 0;
+		test.fn();
+		numRun++;
+
+		if (tests::currentFailures)
+		{
+			numFailed++;
+			fprintf(stderr, "FAIL %.*s\n", int(test.name.size()), test.name.data());
+		}
+		else
+			printf("ok   %.*s\n", int(test.name.size()), test.name.data());
+	}
+
+	printf("%d/%d tests passed\n", numRun - numFailed, numRun);
+	return numFailed ? 1 : 0;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <string_view>
+
+// Minimal test registry for the portable modules, no framework needed so it builds anywhere the bench does
+// TEST() registers a function with the runner in TestMain.cpp, CHECK() failures are counted against the test that's running
+namespace tests
+{
+using TestFn = void (*)();
+
+struct Registrar
+{
+	Registrar(std::string_view name, TestFn fn);
+};
+
+void report_failure(const char* file, int line, const char* expression);
+};
+
+#define TEST(name) \
+	static void name(); \
+	static const tests::Registrar name##_registrar(#name, &name); \
+	static void name()
+
+#define CHECK(expression) \
+	do \
+	{ \
+		if (!(expression)) \
+			tests::report_failure(__FILE__, __LINE__, #expression); \
+	} while (0)
@@ -0,0 +1,87 @@
+#ifndef _WIN32
+#include <sched.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+#endif
+
+#include <cerrno>
+
+#include "ThreadPolicy.hpp"
+#include "Tests.hpp"
+
+namespace
+{
+// Filled in from inside the spawned thread, after Thread has applied its policy
+struct Observed
+{
+	bool ran = false;
+	int nice = 0;
+	int scheduler = 0;
+};
+
+void Observe(void* param)
+{
+	auto& observed = *(Observed*)param;
+	observed.ran = true;
+#ifdef __linux__
+	errno = 0;
+	observed.nice = getpriority(PRIO_PROCESS, id_t(syscall(SYS_gettid)));
+	observed.scheduler = sched_getscheduler(0);
+#endif
+}
+
+Observed RunWithPolicy(const threads::Policy& policy)
+{
+	Observed observed;
+	threads::Thread thread;
+	CHECK(thread.start(Observe, &observed, policy));
+	CHECK(thread.joinable());
+	thread.join();
+	CHECK(!thread.joinable());
+	return observed;
+}
+};
+
+TEST(thread_policy_roundtrip)
+{
+	const auto previous = threads::policy();
+
+	threads::set_policy({ threads::Priority::Idle, true });
+	CHECK(threads::policy().priority == threads::Priority::Idle);
+	CHECK(threads::policy().efficiency);
+
+	threads::set_policy({ threads::Priority::BelowNormal, false });
+	CHECK(threads::policy().priority == threads::Priority::BelowNormal);
+	CHECK(!threads::policy().efficiency);
+
+	threads::set_policy(previous);
+}
+
+TEST(thread_policy_applied_to_thread)
+{
+#ifdef __linux__
+	// Threads start with our own nice value, & lowering it again needs privileges, so only check levels at or above it
+	errno = 0;
+	const int baseNice = getpriority(PRIO_PROCESS, id_t(syscall(SYS_gettid)));
+	CHECK(errno == 0);
+
+	const auto lowest = RunWithPolicy({ threads::Priority::Lowest, false });
+	CHECK(lowest.ran);
+	if (baseNice <= 10)
+		CHECK(lowest.nice == 10);
+	CHECK(lowest.scheduler == SCHED_OTHER);
+
+	const auto idle = RunWithPolicy({ threads::Priority::Idle, false });
+	CHECK(idle.ran);
+	CHECK(idle.nice == 19);
+	CHECK(idle.scheduler == SCHED_IDLE);
+
+	// Policy is per-thread, ours is left alone
+	CHECK(getpriority(PRIO_PROCESS, id_t(syscall(SYS_gettid))) == baseNice);
+#else
+	CHECK(RunWithPolicy({ threads::Priority::Lowest, false }).ran);
+#endif
+}